@@ -4,34 +4,109 @@
 #ifndef ALGORITHM_COMPARISON_TABLE_HPP
 #define ALGORITHM_COMPARISON_TABLE_HPP
 
+#include <cmath>
 #include <tuple>
+#include <array>
 #include <chrono>
 #include <string>
+#include <optional>
+
+#include <cache_info.hpp>
+#include <perf_counters.hpp>
+#include <benchmark_statistics.hpp>
 
 namespace algorithms {
 class algorithm_comparison_table {
 public:
     using us_t = std::chrono::microseconds;
+    using ns_t = std::chrono::nanoseconds;
     using algorithm_name_t = std::string;
+    /* "-" for inputs that are not generated */
+    using distribution_t = std::string;
     using input_size_t = std::int64_t;
     using test_count_t = std::int64_t;
     using comparison_count_t = std::uint64_t;
     using assignment_count_t = std::uint64_t;
-    using median_time_t = us_t;
-    using avg_time_t = us_t;
+    using allocation_count_t = std::uint64_t;
+    using median_time_t = ns_t;
+    using avg_time_t = ns_t;
+    using speedup_t = double;
+
+    /* shown instead of comparisons for algorithms that do not compare keys */
+    struct memory_traffic {
+        double passes;
+        std::uint64_t bytes;
+    };
+    using memory_traffic_t = std::optional<memory_traffic>;
+
+    /* per run averages of the hardware events, empty if an event is not counted */
+    using hardware_counters_t = perf_counters::values_t;
+
+    using time_statistics_t = time_statistics;
+
+    /* cpu time of the thread over wall time of the timed runs, below one when the thread waited for a cpu */
+    using cpu_share_t = std::optional<double>;
+
+    /* time the reader and writer threads spent on files and the sorting thread spent sorting and merging */
+    struct external_times {
+        ns_t io;
+        ns_t cpu;
+    };
+    using external_times_t = std::optional<external_times>;
 
     using test_results_t = std::tuple<
         algorithm_name_t,
+        distribution_t,
         input_size_t,
         test_count_t,
         comparison_count_t,
         assignment_count_t,
+        allocation_count_t,
         median_time_t,
-        avg_time_t
+        avg_time_t,
+        speedup_t,
+        memory_traffic_t,
+        hardware_counters_t,
+        time_statistics_t,
+        cpu_share_t,
+        external_times_t
     >;
 
     algorithm_comparison_table() = default;
 
+    /* adds a column for each hardware event to the rows added afterwards */
+    void show_hardware_counters(bool show) noexcept
+    {
+        m_show_hardware_counters = show;
+    }
+
+    /* adds the minimum, the 90th and 99th percentile, the deviation and the error of the median times */
+    void show_statistics(bool show) noexcept
+    {
+        m_show_statistics = show;
+    }
+
+    /*
+     * adds the median time per element and the cache level that holds the
+     * inputs of elements of the given size, zero removes the columns.
+     */
+    void show_scaling(std::size_t element_size) noexcept
+    {
+        m_scaling_element_size = element_size;
+    }
+
+    /* adds the cpu share of the timed runs, shown when the algorithms run concurrently */
+    void show_cpu_share(bool show) noexcept
+    {
+        m_show_cpu_share = show;
+    }
+
+    /* adds the i/o and cpu times of sorts that spill to files */
+    void show_external_times(bool show) noexcept
+    {
+        m_show_external_times = show;
+    }
+
     void add_title()
     {
         add_table_separator_line();
@@ -39,6 +114,8 @@ public:
             column_separator +
             column("algorithm", algorithm_name_width, format::center) +
             column_separator +
+            column("distribution", distribution_width, format::center) +
+            column_separator +
             column("input size", input_size_width, format::center) +
             column_separator +
             column("# of tests", test_count_width, format::center) +
@@ -47,11 +124,55 @@ public:
             column_separator +
             column("# of assignments", assignment_width, format::center) +
             column_separator +
+            column("# of allocations", allocation_width, format::center) +
+            column_separator +
             column("median time(~)", median_time_width, format::center) +
             column_separator +
             column("average time(~)", avg_time_width, format::center) +
-            column_separator + "\n"
+            column_separator
         );
+        if (m_show_statistics){
+            m_table += (
+                column("minimum time", median_time_width, format::center) +
+                column_separator +
+                column("p90 time", median_time_width, format::center) +
+                column_separator +
+                column("p99 time", median_time_width, format::center) +
+                column_separator +
+                column("std deviation", median_time_width, format::center) +
+                column_separator +
+                column("median error", relative_error_width, format::center) +
+                column_separator +
+                column("outliers", outlier_width, format::center) +
+                column_separator
+            );
+        }
+        if (m_scaling_element_size){
+            m_table += (
+                column("ns/element", ns_per_element_width, format::center) +
+                column_separator +
+                column("inputs in", memory_level_width, format::center) +
+                column_separator
+            );
+        }
+        if (m_show_cpu_share){
+            m_table += column("cpu share", cpu_share_width, format::center) + column_separator;
+        }
+        if (m_show_external_times){
+            m_table += (
+                column("I/O time", median_time_width, format::center) +
+                column_separator +
+                column("cpu time", median_time_width, format::center) +
+                column_separator
+            );
+        }
+        m_table += column("speedup", speedup_width, format::center) + column_separator;
+        if (m_show_hardware_counters){
+            for (const auto& name : perf_counters::event_names){
+                m_table += column(name, hardware_counter_width, format::center) + column_separator;
+            }
+        }
+        m_table += "\n";
     }
 
     void add_table_separator_line()
@@ -63,31 +184,94 @@ public:
     {
         const auto& [
             algorithm_name,
+            distribution,
             input_size,
             test_count,
             comparison,
             assignment,
+            allocation,
             median_time,
-            avg_time
+            avg_time,
+            speedup,
+            memory_traffic,
+            hardware_counters,
+            statistics,
+            cpu_share,
+            external_times
         ] = results;
         add_row_separator_line();
         m_table += (
             column_separator +
             column(algorithm_name, algorithm_name_width, format::center) +
             column_separator +
+            column(distribution, distribution_width, format::center) +
+            column_separator +
             column(readable(input_size), input_size_width, format::right) +
             column_separator +
             column(readable(test_count), test_count_width, format::right) +
             column_separator +
-            column(readable(comparison), comparison_width, format::right) +
+            column(memory_traffic ? readable(*memory_traffic) : readable(comparison),
+                   comparison_width, format::right) +
             column_separator +
             column(readable(assignment), assignment_width, format::right) +
             column_separator +
+            column(readable(allocation), allocation_width, format::right) +
+            column_separator +
             column(readable(median_time), median_time_width, format::center) +
             column_separator +
             column(readable(avg_time), avg_time_width, format::center) +
-            column_separator + "\n"
+            column_separator
         );
+        if (m_show_statistics){
+            m_table += (
+                column(readable(statistics.min), median_time_width, format::center) +
+                column_separator +
+                column(readable(statistics.p90), median_time_width, format::center) +
+                column_separator +
+                column(readable(statistics.p99), median_time_width, format::center) +
+                column_separator +
+                column(readable(statistics.stddev), median_time_width, format::center) +
+                column_separator +
+                column(std::isfinite(statistics.relative_error) ?
+                           std::format("+/-{:.2f}%", statistics.relative_error * 100.) : "-",
+                       relative_error_width, format::center) +
+                column_separator +
+                column(readable(statistics.outliers), outlier_width, format::right) +
+                column_separator
+            );
+        }
+        if (m_scaling_element_size){
+            m_table += (
+                column(std::format("{:.2f}", static_cast<double>(median_time.count()) /
+                                             static_cast<double>(input_size)),
+                       ns_per_element_width, format::right) +
+                column_separator +
+                column(std::string{cache_info::get().memory_level(input_size * m_scaling_element_size)},
+                       memory_level_width, format::center) +
+                column_separator
+            );
+        }
+        if (m_show_cpu_share){
+            m_table += column(cpu_share ? std::format("{:.1f}%", *cpu_share * 100.) : "-",
+                              cpu_share_width, format::right) + column_separator;
+        }
+        if (m_show_external_times){
+            m_table += (
+                column(external_times ? readable(external_times->io) : "-", median_time_width, format::center) +
+                column_separator +
+                column(external_times ? readable(external_times->cpu) : "-", median_time_width, format::center) +
+                column_separator
+            );
+        }
+        m_table += column(speedup > 0 ? std::format("x{:.2f}", speedup) : "-",
+                          speedup_width, format::center) + column_separator;
+        if (m_show_hardware_counters){
+            for (const auto& count : hardware_counters){
+                m_table += column(count ? readable(*count) : "-", hardware_counter_width, format::right) +
+                           column_separator;
+            }
+        }
+        m_table += "\n";
     }
 
     template <typename T>
@@ -97,6 +281,14 @@ public:
         std::string str;
         if constexpr (std::same_as<T, std::string>){
             str = number;
+        } else if constexpr (std::same_as<T, memory_traffic>){
+            static constexpr std::array units{"B", "KiB", "MiB", "GiB", "TiB", "PiB"};
+            auto bytes{static_cast<double>(number.bytes)};
+            std::size_t unit{};
+            while (bytes >= 1024. && unit < units.size() - 1){
+                bytes /= 1024., ++unit;
+            }
+            return std::format("{:.1f} passes {:.1f} {}", number.passes, bytes, units[unit]);
         } else if constexpr (std::same_as<T, std::chrono::microseconds>){
             using namespace std::chrono;
             T us = number;
@@ -110,6 +302,12 @@ public:
                 std::format("{1:{0}}{2}", milliseconds_width, ms.count(), "ms ") +
                 std::format("{1:{0}}{2}", microseconds_width, us.count(), "us")
             );
+        } else if constexpr (std::same_as<T, std::chrono::nanoseconds>){
+            using namespace std::chrono;
+            return (
+                readable(duration_cast<microseconds>(number)) +
+                std::format(" {1:{0}}{2}", nanoseconds_width, (number % 1us).count(), "ns")
+            );
         } else {
             str = std::to_string(number);
         }
@@ -148,23 +346,39 @@ public:
 
 private:
     std::string m_table{};
+    bool m_show_hardware_counters{};
+    bool m_show_statistics{};
+    std::size_t m_scaling_element_size{};
+    bool m_show_cpu_share{};
+    bool m_show_external_times{};
 
     static constexpr char line_element     = '-';
     static constexpr char table_separator  = '+';
     static constexpr char column_separator = '|';
 
-    static constexpr int algorithm_name_width = 13;
+    static constexpr int algorithm_name_width = 15;
+    static constexpr int distribution_width   = 14;
     static constexpr int input_size_width     = 16;
     static constexpr int test_count_width     = 14;
-    static constexpr int comparison_width     = 21;
+    static constexpr int comparison_width     = 25;
     static constexpr int assignment_width     = 21;
-    static constexpr int median_time_width    = 25;
-    static constexpr int avg_time_width       = 25;
+    static constexpr int allocation_width     = 21;
+    static constexpr int median_time_width    = 29;
+    static constexpr int avg_time_width       = 29;
+    static constexpr int relative_error_width = 14;
+    static constexpr int outlier_width        = 10;
+    static constexpr int ns_per_element_width = 14;
+    static constexpr int memory_level_width   = 11;
+    static constexpr int cpu_share_width      = 11;
+    static constexpr int speedup_width        = 11;
+    static constexpr std::size_t statistics_time_column_count = 4;
+    static constexpr int hardware_counter_width = 21;
 
     static constexpr int minutes_width      = 3;
     static constexpr int seconds_width      = 2;
     static constexpr int milliseconds_width = 3;
     static constexpr int microseconds_width = 3;
+    static constexpr int nanoseconds_width  = 3;
 
     enum class format {
         left, center, right
@@ -190,18 +404,45 @@ private:
     }
 
     [[nodiscard]]
-    static std::string horizontal_line(char separator)
+    std::string horizontal_line(char separator) const
     {
-        return (
+        std::string line{
             separator + std::string(algorithm_name_width, line_element) +
+            separator + std::string(distribution_width, line_element) +
             separator + std::string(input_size_width, line_element) +
             separator + std::string(test_count_width, line_element) +
             separator + std::string(comparison_width, line_element) +
             separator + std::string(assignment_width, line_element) +
+            separator + std::string(allocation_width, line_element) +
             separator + std::string(median_time_width, line_element) +
             separator + std::string(avg_time_width, line_element) +
-            separator + "\n"
-        );
+            separator
+        };
+        if (m_show_statistics){
+            for (std::size_t i{}; i < statistics_time_column_count; ++i){
+                line += std::string(median_time_width, line_element) + separator;
+            }
+            line += std::string(relative_error_width, line_element) + separator;
+            line += std::string(outlier_width, line_element) + separator;
+        }
+        if (m_scaling_element_size){
+            line += std::string(ns_per_element_width, line_element) + separator;
+            line += std::string(memory_level_width, line_element) + separator;
+        }
+        if (m_show_cpu_share){
+            line += std::string(cpu_share_width, line_element) + separator;
+        }
+        if (m_show_external_times){
+            line += std::string(median_time_width, line_element) + separator;
+            line += std::string(median_time_width, line_element) + separator;
+        }
+        line += std::string(speedup_width, line_element) + separator;
+        if (m_show_hardware_counters){
+            for (std::size_t i{}; i < perf_counters::event_count; ++i){
+                line += std::string(hardware_counter_width, line_element) + separator;
+            }
+        }
+        return line + "\n";
     }
 
     void add_row_separator_line()
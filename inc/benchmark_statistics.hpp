@@ -0,0 +1,157 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef BENCHMARK_STATISTICS_HPP
+#define BENCHMARK_STATISTICS_HPP
+
+#include <span>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <random_stream.hpp>
+#include <range_algorithms.hpp>
+
+namespace algorithms {
+
+/* summary of the run times of one algorithm */
+struct time_statistics {
+    std::chrono::nanoseconds min;
+    std::chrono::nanoseconds median;
+    std::chrono::nanoseconds p90;
+    std::chrono::nanoseconds p99;
+    /* the mean and the deviation leave out the outliers */
+    std::chrono::nanoseconds mean;
+    std::chrono::nanoseconds stddev;
+    /* half width of the confidence interval of the median, relative to the median */
+    double relative_error;
+    /* the runs outside the tukey fences */
+    std::int64_t outliers;
+};
+
+inline constexpr std::int64_t bootstrap_resamples = 1'000;
+inline constexpr double bootstrap_confidence = 0.95;
+/* the resamples are drawn from a fixed stream, so the same times give the same interval */
+inline constexpr std::uint64_t bootstrap_seed = 0x5eed;
+/* runs further than this many interquartile ranges outside the quartiles are outliers */
+inline constexpr double tukey_fence_factor = 1.5;
+/* fewer runs give quartiles too coarse to tell an outlier */
+inline constexpr std::size_t min_outlier_sample_count = 4;
+
+/* the position of the element below which the given fraction of the samples lie */
+[[nodiscard]] inline std::size_t percentile_index(std::size_t size, double fraction) noexcept
+{
+    return std::min(static_cast<std::size_t>(fraction * static_cast<double>(size)), size - 1);
+}
+
+/*
+ * selects the element below which the given fraction of the samples lie.
+ * the samples before it are not greater and the ones after it are not
+ * smaller afterwards, so larger fractions can be selected from the rest.
+ */
+inline std::int64_t select_percentile(std::span<std::int64_t> samples, double fraction,
+                                      std::size_t first = 0)
+{
+    auto nth{samples.begin() + static_cast<std::ptrdiff_t>(percentile_index(samples.size(), fraction))};
+    ranges::nth_element(samples.begin() + static_cast<std::ptrdiff_t>(first), nth, samples.end());
+    return *nth;
+}
+
+/*
+ * estimates the confidence interval of the median by the percentile
+ * bootstrap: the medians of samples drawn with replacement from the samples
+ * approximate the distribution of the median of the runs. returns the half
+ * width of the interval relative to the median of the samples.
+ */
+[[nodiscard]] inline double
+bootstrap_relative_error(std::span<const std::int64_t> samples,
+                         std::int64_t resamples = bootstrap_resamples)
+{
+    if (samples.size() < 2){
+        return std::numeric_limits<double>::infinity();
+    }
+    const std::uint64_t size{samples.size()};
+    random_stream stream{bootstrap_seed, size};
+    std::vector<std::int64_t> resample(size);
+    std::vector<std::int64_t> medians(resamples);
+    for (std::int64_t i{}; i < resamples; ++i){
+        for (std::uint64_t j{}; j < size; ++j){
+            resample[j] = samples[stream.value<std::uint64_t>(i * size + j, 0, size - 1)];
+        }
+        auto middle{resample.begin() + size / 2};
+        ranges::nth_element(resample, middle);
+        medians[i] = *middle;
+    }
+    auto tail{(1. - bootstrap_confidence) / 2.};
+    auto lower{select_percentile(medians, tail)};
+    auto upper{select_percentile(medians, 1. - tail, percentile_index(medians.size(), tail))};
+    resample.assign(samples.begin(), samples.end());
+    auto middle{resample.begin() + size / 2};
+    ranges::nth_element(resample, middle);
+    if (*middle == 0){
+        return upper == lower ? 0. : std::numeric_limits<double>::infinity();
+    }
+    return static_cast<double>(upper - lower) / 2. / static_cast<double>(*middle);
+}
+
+/*
+ * summarizes the run times, given in nanoseconds, selecting the percentiles
+ * in place instead of sorting. the runs outside the tukey fences, the
+ * quartiles widened by tukey_fence_factor interquartile ranges, are left
+ * out of the mean and the deviation, the percentiles use every run.
+ */
+[[nodiscard]] inline time_statistics summarize(std::vector<std::int64_t>& samples)
+{
+    using std::chrono::nanoseconds;
+    const auto size{samples.size()};
+    auto min{*std::min_element(samples.begin(), samples.end())};
+    auto q1{select_percentile(samples, .25)};
+    auto median{select_percentile(samples, .5, percentile_index(size, .25))};
+    auto q3{select_percentile(samples, .75, percentile_index(size, .5))};
+    auto p90{select_percentile(samples, .9, percentile_index(size, .75))};
+    auto p99{select_percentile(samples, .99, percentile_index(size, .9))};
+    auto lower_fence{-std::numeric_limits<double>::infinity()};
+    auto upper_fence{std::numeric_limits<double>::infinity()};
+    if (size >= min_outlier_sample_count){
+        auto range{static_cast<double>(q3 - q1)};
+        lower_fence = static_cast<double>(q1) - tukey_fence_factor * range;
+        upper_fence = static_cast<double>(q3) + tukey_fence_factor * range;
+    }
+    auto inlier = [lower_fence, upper_fence](std::int64_t sample){
+        return lower_fence <= static_cast<double>(sample) && static_cast<double>(sample) <= upper_fence;
+    };
+    double sum{};
+    std::int64_t kept{};
+    for (auto sample : samples){
+        if (inlier(sample)){
+            sum += static_cast<double>(sample);
+            ++kept;
+        }
+    }
+    auto count{static_cast<double>(kept)};
+    auto mean{sum / count};
+    double squares{};
+    for (auto sample : samples){
+        if (inlier(sample)){
+            squares += (static_cast<double>(sample) - mean) * (static_cast<double>(sample) - mean);
+        }
+    }
+    auto stddev{kept > 1 ? std::sqrt(squares / (count - 1.)) : 0.};
+    return time_statistics{
+        nanoseconds{min},
+        nanoseconds{median},
+        nanoseconds{p90},
+        nanoseconds{p99},
+        nanoseconds{static_cast<std::int64_t>(mean)},
+        nanoseconds{static_cast<std::int64_t>(stddev)},
+        bootstrap_relative_error(samples),
+        static_cast<std::int64_t>(size) - kept
+    };
+}
+
+} /* namespace algorithms */
+
+#endif /* BENCHMARK_STATISTICS_HPP */
@@ -0,0 +1,104 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef CACHE_INFO_HPP
+#define CACHE_INFO_HPP
+
+#include <array>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <string_view>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+
+namespace algorithms {
+
+/*
+ * data cache sizes of the first cpu in bytes, read from sysfs on linux or
+ * from sysconf where the c library provides them. a size that cannot be
+ * found is zero, and that level is left out of memory_level.
+ */
+struct cache_info {
+    std::uint64_t l1d{};
+    std::uint64_t l2{};
+    std::uint64_t l3{};
+
+    [[nodiscard]]
+    static const cache_info& get()
+    {
+        static const cache_info info{detect()};
+        return info;
+    }
+
+    /* the smallest cache level that holds the given number of bytes */
+    [[nodiscard]]
+    std::string_view memory_level(std::uint64_t bytes) const noexcept
+    {
+        if (bytes <= l1d){
+            return "L1";
+        }
+        if (bytes <= l2){
+            return "L2";
+        }
+        if (bytes <= l3){
+            return "L3";
+        }
+        return "DRAM";
+    }
+
+private:
+    [[nodiscard]]
+    static cache_info detect()
+    {
+        cache_info info{};
+        const std::string directory{"/sys/devices/system/cpu/cpu0/cache/index"};
+        for (int index{}; ; ++index){
+            std::ifstream level_file{directory + std::to_string(index) + "/level"};
+            std::ifstream type_file{directory + std::to_string(index) + "/type"};
+            std::ifstream size_file{directory + std::to_string(index) + "/size"};
+            int level{};
+            std::string type, size;
+            if (!(level_file >> level) || !(type_file >> type) || !(size_file >> size)){
+                break;
+            }
+            if (type == "Instruction"){
+                continue;
+            }
+            std::uint64_t bytes{};
+            std::size_t suffix{};
+            try {
+                bytes = std::stoull(size, &suffix);
+            } catch (const std::exception&){
+                continue;
+            }
+            if (suffix < size.size()){
+                bytes <<= size[suffix] == 'K' ? 10 : size[suffix] == 'M' ? 20 : size[suffix] == 'G' ? 30 : 0;
+            }
+            if (level == 1){
+                info.l1d = bytes;
+            } else if (level == 2){
+                info.l2 = bytes;
+            } else if (level == 3){
+                info.l3 = bytes;
+            }
+        }
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+        constexpr std::array<int, 3> names{_SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE};
+        std::array<std::uint64_t*, 3> sizes{&info.l1d, &info.l2, &info.l3};
+        for (std::size_t i{}; i < names.size(); ++i){
+            if (*sizes[i] == 0){
+                auto bytes{::sysconf(names[i])};
+                *sizes[i] = bytes > 0 ? static_cast<std::uint64_t>(bytes) : 0;
+            }
+        }
+#endif
+        return info;
+    }
+};
+
+} /* namespace algorithms */
+
+#endif /* CACHE_INFO_HPP */
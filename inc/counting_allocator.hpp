@@ -0,0 +1,77 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef COUNTING_ALLOCATOR_HPP
+#define COUNTING_ALLOCATOR_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace algorithms {
+
+class allocation_counter {
+public:
+    [[nodiscard]]
+    static std::uint64_t get_allocation_count() noexcept
+    {
+        return m_allocation_count.load(std::memory_order_relaxed);
+    }
+
+    /* the allocations made by the calling thread only */
+    [[nodiscard]]
+    static std::uint64_t get_thread_allocation_count() noexcept
+    {
+        return m_thread_allocation_count;
+    }
+
+protected:
+    static void count_allocation() noexcept
+    {
+        m_allocation_count.fetch_add(1, std::memory_order_relaxed);
+        ++m_thread_allocation_count;
+    }
+
+private:
+    inline static std::atomic<std::uint64_t> m_allocation_count{};
+    inline static thread_local std::uint64_t m_thread_allocation_count{};
+};
+
+/*
+ * std::allocator that counts every allocation made through it, the count is
+ * shared by all value types and threads so that the scratch memory requested
+ * by an algorithm can be measured around a call. each thread also keeps its
+ * own count for calls that run concurrently with others.
+ */
+template <typename T>
+class counting_allocator : public allocation_counter {
+public:
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept { }
+
+    [[nodiscard]]
+    T* allocate(std::size_t n)
+    {
+        count_allocation();
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <typename U>
+    friend bool operator==(const counting_allocator&, const counting_allocator<U>&) noexcept
+    {
+        return true;
+    }
+};
+
+} /* namespace algorithms */
+
+#endif /* COUNTING_ALLOCATOR_HPP */
@@ -0,0 +1,66 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef CPU_AFFINITY_HPP
+#define CPU_AFFINITY_HPP
+
+#include <chrono>
+#include <vector>
+#include <optional>
+
+#if defined(__linux__) && __has_include(<sched.h>)
+#define ALGORITHMS_HAS_AFFINITY 1
+#include <time.h>
+#include <sched.h>
+#else
+#define ALGORITHMS_HAS_AFFINITY 0
+#endif
+
+namespace algorithms {
+
+/* the cpus the calling thread may run on, empty if they cannot be queried */
+[[nodiscard]] inline std::vector<int> allowed_cpus()
+{
+    std::vector<int> cpus;
+#if ALGORITHMS_HAS_AFFINITY
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0){
+        for (int cpu{}; cpu < CPU_SETSIZE; ++cpu){
+            if (CPU_ISSET(cpu, &set)){
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+/* restricts the calling thread to one cpu, false if it cannot be pinned */
+inline bool pin_thread([[maybe_unused]] int cpu) noexcept
+{
+#if ALGORITHMS_HAS_AFFINITY
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+/* the time the calling thread has run on a cpu, empty if it cannot be measured */
+[[nodiscard]] inline std::optional<std::chrono::nanoseconds> thread_cpu_time() noexcept
+{
+#if ALGORITHMS_HAS_AFFINITY
+    timespec time{};
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0){
+        return std::chrono::seconds{time.tv_sec} + std::chrono::nanoseconds{time.tv_nsec};
+    }
+#endif
+    return std::nullopt;
+}
+
+} /* namespace algorithms */
+
+#endif /* CPU_AFFINITY_HPP */
@@ -0,0 +1,165 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef D_ARY_HEAP_SORT_HPP
+#define D_ARY_HEAP_SORT_HPP
+
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+#include <operation_counter.hpp>
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+/* the size of a cache line the children of an aligned heap node are laid out in */
+inline constexpr std::size_t heap_cache_line_size = 64;
+
+/*
+ * heap sorts on max heaps where every node has Arity children, node k of
+ * the heap is heap[k] and its children are heap[Arity * k + 1] to
+ * heap[Arity * k + Arity]. a wider heap is shallower, so a sift down
+ * touches fewer cache lines for more comparisons per level. the sift downs
+ * move a hole instead of swapping: the heap is built bottom up with sift
+ * downs that stop early, and every extraction uses floyd's bottom-up
+ * variant, which moves the hole left at the root down along the largest
+ * children to a leaf without comparing them to the last input, then sifts
+ * that input up from the leaf, as it mostly belongs close to the bottom.
+ * with Prefetch the grandchildren of a node are prefetched while its
+ * children are compared.
+ */
+namespace d_ary_heap {
+
+template <std::size_t Arity, bool Prefetch, algorithm_value_type ValueType>
+inline void prefetch_grandchildren(const ValueType* heap, std::size_t first_child, std::size_t last_child,
+                                   std::size_t size) noexcept
+{
+    if constexpr (Prefetch){
+        constexpr std::size_t line_values{std::max<std::size_t>(heap_cache_line_size / sizeof(ValueType), 1)};
+        auto first{Arity * first_child + 1};
+        auto last{std::min(Arity * (last_child - 1) + Arity + 1, size)};
+        for (auto i{first}; i < last; i += line_values){
+            __builtin_prefetch(heap + i);
+        }
+    }
+}
+
+/* the largest of the children heap[first_child, last_child), picked without branches */
+template <algorithm_value_type ValueType, operation_counter Counter>
+[[nodiscard]] inline std::size_t largest_child(const ValueType* heap, std::size_t first_child, std::size_t last_child,
+                                               Counter& comparison) noexcept
+{
+    auto largest{first_child};
+    for (auto child{first_child + 1}; child < last_child; ++child){
+        ++comparison;
+        largest = heap[largest] < heap[child] ? child : largest;
+    }
+    return largest;
+}
+
+template <std::size_t Arity, bool Prefetch, algorithm_value_type ValueType, operation_counter Counter>
+void sift_down(ValueType* heap, std::size_t size, std::size_t node, Counter& comparison, Counter& assignment)
+{
+    ValueType value{std::move(heap[node])};
+    auto hole{node};
+    for (auto first_child{Arity * hole + 1}; first_child < size; first_child = Arity * hole + 1){
+        auto last_child{std::min(first_child + Arity, size)};
+        prefetch_grandchildren<Arity, Prefetch>(heap, first_child, last_child, size);
+        auto largest{largest_child(heap, first_child, last_child, comparison)};
+        ++comparison;
+        if (!(value < heap[largest])){
+            break;
+        }
+        heap[hole] = std::move(heap[largest]);
+        ++assignment;
+        hole = largest;
+    }
+    heap[hole] = std::move(value);
+    assignment += 2;
+}
+
+/* puts value in the heap of size inputs whose root is a hole */
+template <std::size_t Arity, bool Prefetch, algorithm_value_type ValueType, operation_counter Counter>
+void floyd_sift_down(ValueType* heap, std::size_t size, ValueType value, Counter& comparison, Counter& assignment)
+{
+    std::size_t hole{};
+    for (auto first_child{std::size_t{1}}; first_child < size; first_child = Arity * hole + 1){
+        auto last_child{std::min(first_child + Arity, size)};
+        prefetch_grandchildren<Arity, Prefetch>(heap, first_child, last_child, size);
+        auto largest{largest_child(heap, first_child, last_child, comparison)};
+        heap[hole] = std::move(heap[largest]);
+        ++assignment;
+        hole = largest;
+    }
+    while (hole > 0){
+        auto parent{(hole - 1) / Arity};
+        ++comparison;
+        if (!(heap[parent] < value)){
+            break;
+        }
+        heap[hole] = std::move(heap[parent]);
+        ++assignment;
+        hole = parent;
+    }
+    heap[hole] = std::move(value);
+    ++assignment;
+}
+
+/*
+ * sorts values through the heap, which is either values itself or a copy of
+ * them elsewhere. the largest input left is moved from the root to the end
+ * of values in both cases.
+ */
+template <std::size_t Arity, bool Prefetch, algorithm_value_type ValueType, operation_counter Counter>
+void sort(std::span<ValueType> values, ValueType* heap, Counter& comparison, Counter& assignment)
+{
+    static_assert(Arity >= 2, "a heap node needs at least two children");
+    const auto size{values.size()};
+    if (size < 2){
+        return;
+    }
+    for (auto node{(size - 2) / Arity + 1}; node-- > 0;){
+        sift_down<Arity, Prefetch>(heap, size, node, comparison, assignment);
+    }
+    for (auto end{size - 1}; end > 0; --end){
+        ValueType last{std::move(heap[end])};
+        values[end] = std::move(heap[0]);
+        assignment += 2;
+        floyd_sift_down<Arity, Prefetch>(heap, end, std::move(last), comparison, assignment);
+    }
+    if (heap != values.data()){
+        values[0] = std::move(heap[0]);
+        ++assignment;
+    }
+}
+
+/*
+ * resizes buffer to hold a heap of size inputs whose sibling groups start
+ * on a multiple of their size, or of a cache line when they are larger,
+ * and returns the root. groups of siblings then never straddle more cache
+ * lines than they have to.
+ */
+template <std::size_t Arity, algorithm_value_type ValueType, typename Allocator>
+[[nodiscard]] ValueType* aligned_heap(std::vector<ValueType, Allocator>& buffer, std::size_t size)
+{
+    constexpr std::size_t group_alignment{std::min(Arity * sizeof(ValueType), heap_cache_line_size)};
+    constexpr std::size_t padding{group_alignment / sizeof(ValueType)};
+    buffer.resize(size + padding);
+    /* the first sibling group, the children of the root, starts right after it */
+    for (std::size_t offset{}; offset < padding; ++offset){
+        if (reinterpret_cast<std::uintptr_t>(buffer.data() + offset + 1) % group_alignment == 0){
+            return buffer.data() + offset;
+        }
+    }
+    return buffer.data();
+}
+
+} /* namespace d_ary_heap */
+
+} /* namespace algorithms */
+
+#endif /* D_ARY_HEAP_SORT_HPP */
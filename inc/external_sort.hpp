@@ -0,0 +1,580 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+#include <span>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+
+#include <input_file.hpp>
+#include <random_stream.hpp>
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+/* parses a byte count with an optional K, M, G or T suffix of powers of 1024 */
+[[nodiscard]] inline std::uint64_t parse_byte_size(std::string_view size)
+{
+    std::uint64_t bytes{};
+    auto [end, error]{std::from_chars(size.data(), size.data() + size.size(), bytes)};
+    std::string_view suffix{end, static_cast<std::size_t>(size.data() + size.size() - end)};
+    if (error != std::errc{} || suffix.size() > 1 ||
+        (suffix.size() == 1 && std::string_view{"KMGTkmgt"}.find(suffix.front()) == std::string_view::npos)){
+        throw std::runtime_error{"invalid byte size " + std::string{size} + ", expected a number with K, M, G or T"};
+    }
+    int shift{};
+    if (!suffix.empty()){
+        shift = 10 * (1 + static_cast<int>(std::string_view{"KMGT"}.find(static_cast<char>(suffix.front() & ~0x20))));
+    }
+    if (shift > 0 && bytes > (std::uint64_t{1} << (64 - shift)) - 1){
+        throw std::runtime_error{"byte size " + std::string{size} + " is too large"};
+    }
+    return bytes << shift;
+}
+
+/*
+ * the time an external sort spent on each side: io is the time the reader
+ * and writer threads spent reading, parsing and writing, cpu is the time
+ * the sorting thread spent sorting runs and merging, not waiting for io.
+ * both overlap, so their sum can exceed the wall time.
+ */
+struct external_sort_stats {
+    std::chrono::nanoseconds wall_time;
+    std::chrono::nanoseconds io_time;
+    std::chrono::nanoseconds cpu_time;
+    std::uint64_t count;
+    std::uint64_t runs;
+    std::uint64_t merge_passes;
+    std::uint64_t bytes_read;
+    std::uint64_t bytes_written;
+};
+
+/*
+ * sorts files larger than the memory in two phases. runs of inputs that fit
+ * in the memory limit are sorted and spilled to temporary files while the
+ * next run is read and the previous one is written. the runs are then
+ * merged with a loser tree, every run is read through a double buffer that
+ * is refilled by another thread and the output is written behind the merge
+ * the same way. if the runs are too many for the buffers to stay large, they
+ * are merged in several passes.
+ */
+template <algorithm_value_type ValueType>
+class external_sorter {
+public:
+    using run_sorter_t = std::function<void(std::vector<ValueType>&)>;
+
+    static constexpr std::uint64_t min_memory_limit = 1UL << 20;
+    /* smaller blocks make every run read a seek */
+    static constexpr std::uint64_t min_block_size = 1UL << 16;
+
+    external_sorter(std::uint64_t memory_limit, std::filesystem::path temp_directory, run_sorter_t run_sorter)
+        : m_memory_limit{memory_limit},
+        m_temp_directory{std::move(temp_directory)},
+        m_run_sorter{std::move(run_sorter)}
+    {
+        if (m_memory_limit < min_memory_limit){
+            throw std::runtime_error{"memory limit cannot be smaller than " + std::to_string(min_memory_limit >> 20) + " MiB"};
+        }
+    }
+
+    /* reads the inputs of a text or binary input file in order, without holding more than the mapping */
+    class input_reader {
+    public:
+        explicit input_reader(const std::string& file_name)
+            : m_file{file_name},
+            m_file_name{file_name},
+            m_position{m_file.data()},
+            m_end{m_file.data() + m_file.size()}
+        {
+            const auto& magic{binary_input_header::file_magic};
+            if (m_file.size() < sizeof(binary_input_header) ||
+                !std::equal(magic.begin(), magic.end(), m_file.data())){
+                return;
+            }
+            binary_input_header header;
+            std::memcpy(&header, m_file.data(), sizeof(header));
+            m_swap_bytes = header.endianness != binary_input_header::native_byte_order();
+            if (m_swap_bytes){
+                header.count = byte_swapped(header.count);
+            }
+            if (header.kind != binary_input_header::kind_of<ValueType>() ||
+                header.value_size != sizeof(ValueType)){
+                throw std::runtime_error{file_name + " does not hold inputs of the sorted type"};
+            }
+            if (header.count > (m_file.size() - sizeof(header)) / sizeof(ValueType)){
+                throw std::runtime_error{file_name + " is truncated"};
+            }
+            m_binary = true;
+            m_position += sizeof(header);
+            m_end = m_position + header.count * sizeof(ValueType);
+        }
+
+        /* fills values from the front, returns how many were read, zero at the end of the file */
+        std::size_t read(std::span<ValueType> values)
+        {
+            if (m_binary){
+                auto count{std::min(values.size(), static_cast<std::size_t>(m_end - m_position) / sizeof(ValueType))};
+                std::memcpy(values.data(), m_position, count * sizeof(ValueType));
+                m_position += count * sizeof(ValueType);
+                if (m_swap_bytes){
+                    for (auto& value : values.first(count)){
+                        value = byte_swapped(value);
+                    }
+                }
+                return count;
+            }
+            std::size_t count{};
+            while (count < values.size()){
+                while (m_position < m_end && is_input_separator(*m_position)){
+                    ++m_position;
+                }
+                if (m_position == m_end){
+                    break;
+                }
+                auto token_end{std::find_if(m_position, m_end, is_input_separator)};
+                parse_text_values(m_position, m_position, m_position + 1, token_end, &values[count], m_file_name);
+                m_position = token_end;
+                ++count;
+            }
+            return count;
+        }
+
+    private:
+        mapped_file m_file;
+        std::string m_file_name;
+        const char* m_position;
+        const char* m_end;
+        bool m_binary{};
+        bool m_swap_bytes{};
+    };
+
+    /* the sorted run, the run being read, the run being written and the scratch memory of the sort share the limit */
+    [[nodiscard]]
+    std::size_t get_run_size() const noexcept
+    {
+        return std::max<std::size_t>(m_memory_limit / (4 * sizeof(ValueType)), 1);
+    }
+
+    external_sort_stats sort(const std::string& input_file, const std::string& output_file, input_file_format format)
+    {
+        m_io_time = 0;
+        m_wait_time = 0;
+        m_bytes_read = 0;
+        m_bytes_written = 0;
+        auto start{std::chrono::steady_clock::now()};
+        auto [runs, count]{make_runs(input_file)};
+        std::uint64_t run_count{runs.size()};
+        std::uint64_t merge_passes{};
+        auto fan_in{merge_fan_in()};
+        while (runs.size() > fan_in){
+            std::vector<temp_file> merged;
+            for (std::size_t first{}; first < runs.size(); first += fan_in){
+                auto last{std::min(first + fan_in, runs.size())};
+                merged.emplace_back(next_temp_file());
+                run_writer output{merged.back().path, input_file_format::binary, false, 0, block_size(fan_in), *this};
+                merge(std::span{runs}.subspan(first, last - first), output);
+            }
+            runs = std::move(merged);
+            ++merge_passes;
+        }
+        run_writer output{output_file, format, true, count, block_size(runs.size()), *this};
+        merge(runs, output);
+        ++merge_passes;
+        auto wall_time{std::chrono::steady_clock::now() - start};
+        return external_sort_stats{
+            wall_time, std::chrono::nanoseconds{m_io_time.load()},
+            wall_time - std::chrono::nanoseconds{m_wait_time.load()},
+            count, run_count, merge_passes, m_bytes_read.load(), m_bytes_written.load()
+        };
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::uint64_t m_memory_limit;
+    std::filesystem::path m_temp_directory;
+    run_sorter_t m_run_sorter;
+    std::uint64_t m_file_key{random_seed()};
+    std::uint64_t m_file_count{};
+    std::atomic<std::int64_t> m_io_time{};
+    std::atomic<std::int64_t> m_wait_time{};
+    std::atomic<std::uint64_t> m_bytes_read{};
+    std::atomic<std::uint64_t> m_bytes_written{};
+
+    /* a temporary file that is removed with its owner */
+    struct temp_file {
+        std::filesystem::path path;
+
+        explicit temp_file(std::filesystem::path file_path) noexcept
+            : path{std::move(file_path)} { }
+
+        temp_file(temp_file&& other) noexcept
+            : path{std::exchange(other.path, {})} { }
+
+        temp_file& operator=(temp_file&& other) noexcept
+        {
+            std::swap(path, other.path);
+            return *this;
+        }
+
+        ~temp_file()
+        {
+            if (!path.empty()){
+                std::error_code error;
+                std::filesystem::remove(path, error);
+            }
+        }
+    };
+
+    /* runs function and adds its duration to counter */
+    template <typename Function>
+    static auto timed(std::atomic<std::int64_t>& counter, Function&& function)
+    {
+        auto start{clock::now()};
+        struct add_duration {
+            std::atomic<std::int64_t>& counter;
+            clock::time_point start;
+            ~add_duration()
+            {
+                counter += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+            }
+        } guard{counter, start};
+        return function();
+    }
+
+    [[nodiscard]]
+    temp_file next_temp_file()
+    {
+        return temp_file{m_temp_directory / ("sorting-algorithms-" + std::to_string(m_file_key) + "-" +
+                                             std::to_string(m_file_count++) + ".run")};
+    }
+
+    /* every input run and the output are double buffered */
+    [[nodiscard]]
+    std::size_t merge_fan_in() const noexcept
+    {
+        return std::max<std::size_t>(m_memory_limit / (2 * min_block_size), 3) - 1;
+    }
+
+    [[nodiscard]]
+    std::size_t block_size(std::size_t run_count) const noexcept
+    {
+        auto bytes{std::max<std::uint64_t>(m_memory_limit / (2 * (run_count + 1)), min_block_size)};
+        return std::max<std::size_t>(bytes / sizeof(ValueType), 1);
+    }
+
+    /* a run file read in blocks, the next block is read by another thread while this one is merged */
+    class run_reader {
+    public:
+        run_reader(const std::filesystem::path& path, std::size_t block_size, external_sorter& sorter)
+            : m_file{path, std::ios::binary},
+            m_current(block_size),
+            m_next(block_size),
+            m_sorter{sorter}
+        {
+            if (!m_file){
+                throw std::runtime_error{"failed to open " + path.string()};
+            }
+            m_current.resize(read_block(m_current));
+            m_pending = std::async(std::launch::async, [this](){ return read_block(m_next); });
+        }
+
+        run_reader(const run_reader&) = delete;
+        run_reader& operator=(const run_reader&) = delete;
+
+        ~run_reader()
+        {
+            if (m_pending.valid()){
+                m_pending.wait();
+            }
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept
+        {
+            return m_position == m_current.size();
+        }
+
+        [[nodiscard]]
+        const ValueType& front() const noexcept
+        {
+            return m_current[m_position];
+        }
+
+        void pop()
+        {
+            if (++m_position < m_current.size()){
+                return;
+            }
+            auto count{timed(m_sorter.m_wait_time, [this](){ return m_pending.get(); })};
+            m_current.resize(m_current.capacity());
+            std::swap(m_current, m_next);
+            m_current.resize(count);
+            m_position = 0;
+            if (count > 0){
+                m_pending = std::async(std::launch::async, [this](){ return read_block(m_next); });
+            }
+        }
+
+    private:
+        std::ifstream m_file;
+        std::vector<ValueType> m_current;
+        std::vector<ValueType> m_next;
+        std::size_t m_position{};
+        std::future<std::size_t> m_pending;
+        external_sorter& m_sorter;
+
+        std::size_t read_block(std::vector<ValueType>& block)
+        {
+            return timed(m_sorter.m_io_time, [&](){
+                block.resize(block.capacity());
+                m_file.read(reinterpret_cast<char*>(block.data()),
+                            static_cast<std::streamsize>(block.size() * sizeof(ValueType)));
+                auto count{static_cast<std::size_t>(m_file.gcount()) / sizeof(ValueType)};
+                m_sorter.m_bytes_read += count * sizeof(ValueType);
+                return count;
+            });
+        }
+    };
+
+    /* the output of a merge, a full block is written by another thread while the next one is filled */
+    class run_writer {
+    public:
+        run_writer(const std::filesystem::path& path, input_file_format format, bool with_header,
+                   std::uint64_t count, std::size_t block_size, external_sorter& sorter)
+            : m_block_size{block_size},
+            m_sorter{sorter}
+        {
+            if (with_header){
+                m_file.emplace(path.string(), format, count);
+            } else {
+                m_raw_file.open(path, std::ios::binary);
+                if (!m_raw_file){
+                    throw std::runtime_error{"failed to create " + path.string()};
+                }
+            }
+        }
+
+        run_writer(const run_writer&) = delete;
+        run_writer& operator=(const run_writer&) = delete;
+
+        ~run_writer()
+        {
+            if (m_pending.valid()){
+                m_pending.wait();
+            }
+        }
+
+        void push(const ValueType& value)
+        {
+            if (m_current.capacity() == 0){
+                m_current.reserve(m_block_size);
+            }
+            m_current.push_back(value);
+            if (m_current.size() == m_block_size){
+                flush();
+            }
+        }
+
+        /* writes a whole run, the caller keeps it alive until the next write or finish */
+        void write(std::span<const ValueType> values)
+        {
+            wait();
+            m_pending = std::async(std::launch::async, [this, values](){ write_block(values); });
+        }
+
+        void finish()
+        {
+            flush();
+            wait();
+        }
+
+    private:
+        std::optional<input_file_writer<ValueType>> m_file;
+        std::ofstream m_raw_file;
+        std::vector<ValueType> m_current;
+        std::vector<ValueType> m_next;
+        std::size_t m_block_size;
+        std::future<void> m_pending;
+        external_sorter& m_sorter;
+
+        void wait()
+        {
+            if (m_pending.valid()){
+                timed(m_sorter.m_wait_time, [this](){ m_pending.get(); });
+            }
+        }
+
+        void flush()
+        {
+            if (m_current.empty()){
+                return;
+            }
+            wait();
+            std::swap(m_current, m_next);
+            m_current.clear();
+            m_pending = std::async(std::launch::async, [this](){ write_block(m_next); });
+        }
+
+        void write_block(std::span<const ValueType> values)
+        {
+            timed(m_sorter.m_io_time, [&](){
+                if (m_file){
+                    m_file->write(values);
+                } else {
+                    m_raw_file.write(reinterpret_cast<const char*>(values.data()),
+                                     static_cast<std::streamsize>(values.size_bytes()));
+                    if (!m_raw_file){
+                        throw std::runtime_error{"failed to write a run, the temporary directory may be full"};
+                    }
+                }
+                m_sorter.m_bytes_written += values.size_bytes();
+            });
+        }
+    };
+
+    /*
+     * the tree holds the loser of the match played at every inner node and
+     * the overall winner at the root, so replacing the winner replays only
+     * the matches on the path from its leaf to the root.
+     */
+    class loser_tree {
+    public:
+        explicit loser_tree(std::span<run_reader*> runs)
+            : m_runs{runs},
+            m_tree(runs.size())
+        {
+            m_tree[0] = build(1);
+        }
+
+        [[nodiscard]]
+        std::size_t winner() const noexcept
+        {
+            return m_tree[0];
+        }
+
+        /* replays the matches of the winner after its front changed */
+        void replay() noexcept
+        {
+            auto winner{m_tree[0]};
+            for (auto node{(winner + m_runs.size()) / 2}; node > 0; node /= 2){
+                if (wins(m_tree[node], winner)){
+                    std::swap(m_tree[node], winner);
+                }
+            }
+            m_tree[0] = winner;
+        }
+
+    private:
+        std::span<run_reader*> m_runs;
+        std::vector<std::size_t> m_tree;
+
+        /* empty runs lose every match, equal fronts are won by the earlier run to keep the merge stable */
+        [[nodiscard]]
+        bool wins(std::size_t a, std::size_t b) const noexcept
+        {
+            if (m_runs[a]->empty() || m_runs[b]->empty()){
+                return !m_runs[a]->empty();
+            }
+            return m_runs[a]->front() < m_runs[b]->front() ||
+                   (!(m_runs[b]->front() < m_runs[a]->front()) && a < b);
+        }
+
+        std::size_t build(std::size_t node)
+        {
+            if (node >= m_runs.size()){
+                return node - m_runs.size();
+            }
+            auto left{build(2 * node)};
+            auto right{build(2 * node + 1)};
+            if (wins(left, right)){
+                m_tree[node] = right;
+                return left;
+            }
+            m_tree[node] = left;
+            return right;
+        }
+    };
+
+    std::pair<std::vector<temp_file>, std::uint64_t> make_runs(const std::string& input_file)
+    {
+        input_reader input{input_file};
+        std::vector<temp_file> runs;
+        std::uint64_t count{};
+        std::array<std::vector<ValueType>, 3> buffers;
+        auto read = [&](std::vector<ValueType>& buffer){
+            return timed(m_io_time, [&](){
+                buffer.resize(get_run_size());
+                buffer.resize(input.read(buffer));
+                m_bytes_read += buffer.size() * sizeof(ValueType);
+            });
+        };
+        std::future<void> reading{std::async(std::launch::async, read, std::ref(buffers[0]))};
+        std::optional<run_writer> writer;
+        for (std::size_t i{}; ; ++i){
+            timed(m_wait_time, [&](){ reading.get(); });
+            auto& run{buffers[i % buffers.size()]};
+            if (run.empty()){
+                break;
+            }
+            count += run.size();
+            reading = std::async(std::launch::async, read, std::ref(buffers[(i + 1) % buffers.size()]));
+            m_run_sorter(run);
+            if (writer){
+                writer->finish();
+            }
+            runs.push_back(next_temp_file());
+            writer.emplace(runs.back().path, input_file_format::binary, false, 0, run.size(), *this);
+            writer->write(run);
+        }
+        if (writer){
+            writer->finish();
+        }
+        return {std::move(runs), count};
+    }
+
+    void merge(std::span<temp_file> runs, run_writer& output)
+    {
+        std::vector<std::unique_ptr<run_reader>> readers;
+        std::vector<run_reader*> fronts;
+        for (auto& run : runs){
+            readers.push_back(std::make_unique<run_reader>(run.path, block_size(runs.size()), *this));
+            fronts.push_back(readers.back().get());
+        }
+        if (!fronts.empty()){
+            loser_tree tree{fronts};
+            for (auto winner{tree.winner()}; !fronts[winner]->empty(); winner = tree.winner()){
+                output.push(fronts[winner]->front());
+                fronts[winner]->pop();
+                tree.replay();
+            }
+        }
+        output.finish();
+        readers.clear();
+        for (auto& run : runs){
+            run = temp_file{{}};
+        }
+    }
+};
+
+} /* namespace algorithms */
+
+#endif /* EXTERNAL_SORT_HPP */
@@ -0,0 +1,163 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef INPUT_DISTRIBUTION_HPP
+#define INPUT_DISTRIBUTION_HPP
+
+#include <span>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+#include <task_pool.hpp>
+#include <input_file.hpp>
+#include <random_stream.hpp>
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+enum class input_distribution {
+    uniform, sorted, reverse, swapped, sawtooth, organ_pipe, few_unique, zipf
+};
+
+inline constexpr std::array input_distribution_names{
+    std::pair{input_distribution::uniform,    std::string_view{"uniform"}},
+    std::pair{input_distribution::sorted,     std::string_view{"sorted"}},
+    std::pair{input_distribution::reverse,    std::string_view{"reverse"}},
+    std::pair{input_distribution::swapped,    std::string_view{"swapped"}},
+    std::pair{input_distribution::sawtooth,   std::string_view{"sawtooth"}},
+    std::pair{input_distribution::organ_pipe, std::string_view{"organ-pipe"}},
+    std::pair{input_distribution::few_unique, std::string_view{"few-unique"}},
+    std::pair{input_distribution::zipf,       std::string_view{"zipf"}}
+};
+
+inline constexpr std::uint64_t input_distribution_chunk_size = 1UL << 16;
+/* percentage of the elements of sorted inputs that are swapped in pairs */
+inline constexpr std::uint64_t swapped_input_percent = 1;
+inline constexpr std::uint64_t sawtooth_input_teeth = 16;
+inline constexpr std::uint64_t few_unique_input_count = 16;
+/* zipf inputs have this many distinct values, the k-th most frequent one appears with probability ~ 1/k */
+inline constexpr std::uint64_t zipf_input_ranks = 1UL << 16;
+
+[[nodiscard]] inline std::string to_string(input_distribution distribution)
+{
+    for (const auto& [value, name] : input_distribution_names){
+        if (value == distribution){
+            return std::string{name};
+        }
+    }
+    throw std::runtime_error{"unknown input distribution"};
+}
+
+/* parses a comma separated list of distribution names, "all" selects every distribution */
+[[nodiscard]] inline std::vector<input_distribution>
+parse_input_distributions(std::string_view names)
+{
+    std::vector<input_distribution> distributions;
+    while (!names.empty()){
+        auto separator{names.find(',')};
+        auto name{names.substr(0, separator)};
+        names = separator == std::string_view::npos ? std::string_view{} : names.substr(separator + 1);
+        if (name == "all"){
+            for (const auto& entry : input_distribution_names){
+                distributions.push_back(entry.first);
+            }
+            continue;
+        }
+        auto entry{std::find_if(input_distribution_names.begin(), input_distribution_names.end(),
+            [name](const auto& entry){ return entry.second == name; }
+        )};
+        if (entry == input_distribution_names.end()){
+            throw std::runtime_error{"unknown input distribution " + std::string{name}};
+        }
+        distributions.push_back(entry->first);
+    }
+    if (distributions.empty()){
+        throw std::runtime_error{"no input distribution is selected"};
+    }
+    return distributions;
+}
+
+/*
+ * fills values with the given distribution of the numbers of stream. the
+ * i-th element is drawn from the i-th number of the stream, distinct values
+ * of few-unique and zipf inputs and the swapped positions are drawn from the
+ * numbers after the last element, so the inputs only depend on the stream.
+ */
+template <algorithm_value_type ValueType>
+void generate_input_distribution(std::span<ValueType> values,
+                                 input_distribution distribution,
+                                 const random_stream& stream,
+                                 ValueType min, ValueType max,
+                                 task_pool* pool = nullptr)
+{
+    const std::uint64_t size{values.size()};
+    std::vector<double> zipf_cdf;
+    if (distribution == input_distribution::zipf){
+        zipf_cdf.resize(zipf_input_ranks);
+        double sum{};
+        for (std::uint64_t rank{}; rank < zipf_input_ranks; ++rank){
+            zipf_cdf[rank] = sum += 1. / static_cast<double>(rank + 1);
+        }
+        for (auto& probability : zipf_cdf){
+            probability /= sum;
+        }
+    }
+    auto chunk_count{(size + input_distribution_chunk_size - 1) / input_distribution_chunk_size};
+    for_each_input_chunk(chunk_count, pool, [&](std::size_t chunk){
+        auto last{std::min<std::uint64_t>((chunk + 1) * input_distribution_chunk_size, size)};
+        for (std::uint64_t i{chunk * input_distribution_chunk_size}; i < last; ++i){
+            if (distribution == input_distribution::few_unique){
+                auto k{stream.value<std::uint64_t>(i, 0, few_unique_input_count - 1)};
+                values[i] = stream.value(size + k, min, max);
+            } else if (distribution == input_distribution::zipf){
+                auto rank{std::upper_bound(zipf_cdf.begin(), zipf_cdf.end() - 1,
+                                           stream.value(i, 0., 1.)) - zipf_cdf.begin()};
+                values[i] = stream.value(size + static_cast<std::uint64_t>(rank), min, max);
+            } else {
+                values[i] = stream.value(i, min, max);
+            }
+        }
+    });
+    switch (distribution){
+    case input_distribution::sorted:
+        std::sort(values.begin(), values.end());
+        break;
+    case input_distribution::reverse:
+        std::sort(values.begin(), values.end(), std::greater<>{});
+        break;
+    case input_distribution::swapped:
+        std::sort(values.begin(), values.end());
+        if (size > 1){
+            for (std::uint64_t k{}; k < size * swapped_input_percent / 200; ++k){
+                std::swap(values[stream.value<std::uint64_t>(size + 2 * k, 0, size - 1)],
+                          values[stream.value<std::uint64_t>(size + 2 * k + 1, 0, size - 1)]);
+            }
+        }
+        break;
+    case input_distribution::sawtooth: {
+        auto tooth{std::max<std::uint64_t>(size / sawtooth_input_teeth, 1)};
+        for (std::uint64_t first{}; first < size; first += tooth){
+            std::sort(values.begin() + first, values.begin() + std::min(first + tooth, size));
+        }
+        break;
+    }
+    case input_distribution::organ_pipe:
+        std::sort(values.begin(), values.begin() + size / 2);
+        std::sort(values.begin() + size / 2, values.end(), std::greater<>{});
+        break;
+    default:
+        break;
+    }
+}
+
+} /* namespace algorithms */
+
+#endif /* INPUT_DISTRIBUTION_HPP */
@@ -0,0 +1,364 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef INPUT_FILE_HPP
+#define INPUT_FILE_HPP
+
+#include <bit>
+#include <span>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <limits>
+#include <cstring>
+#include <fstream>
+#include <charconv>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+
+#if __has_include(<sys/mman.h>)
+#define ALGORITHMS_HAS_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#define ALGORITHMS_HAS_MMAP 0
+#endif
+
+#include <task_pool.hpp>
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+enum class input_file_format {
+    text, binary
+};
+
+/*
+ * binary input files start with this header followed by the raw keys, the
+ * keys and the element count are stored in the byte order of the writer
+ * and are swapped on load if it differs from the byte order of the reader.
+ */
+struct binary_input_header {
+    static constexpr std::array<char, 8> file_magic{'S', 'O', 'R', 'T', 'I', 'N', 'P', 'T'};
+
+    enum class value_kind : std::uint8_t {
+        signed_integer = 1, unsigned_integer = 2, floating_point = 3
+    };
+
+    enum class byte_order : std::uint8_t {
+        little = 1, big = 2
+    };
+
+    std::array<char, 8> magic{file_magic};
+    value_kind kind{};
+    std::uint8_t value_size{};
+    byte_order endianness{};
+    std::array<std::uint8_t, 5> reserved_1{};
+    std::uint64_t count{};
+    std::uint64_t reserved_2{};
+
+    template <algorithm_value_type ValueType>
+    [[nodiscard]] static constexpr value_kind kind_of() noexcept
+    {
+        if constexpr (std::floating_point<ValueType>){
+            return value_kind::floating_point;
+        } else if constexpr (std::signed_integral<ValueType>){
+            return value_kind::signed_integer;
+        } else {
+            return value_kind::unsigned_integer;
+        }
+    }
+
+    [[nodiscard]] static constexpr byte_order native_byte_order() noexcept
+    {
+        return std::endian::native == std::endian::big ? byte_order::big : byte_order::little;
+    }
+};
+
+static_assert(sizeof(binary_input_header) == 32);
+
+template <typename T>
+[[nodiscard]] T byte_swapped(const T& value) noexcept
+{
+    auto bytes{std::bit_cast<std::array<std::byte, sizeof(T)>>(value)};
+    std::reverse(bytes.begin(), bytes.end());
+    return std::bit_cast<T>(bytes);
+}
+
+/* read-only view of a whole file, memory mapped where the platform allows it */
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& file_name)
+    {
+#if ALGORITHMS_HAS_MMAP
+        int fd{::open(file_name.c_str(), O_RDONLY)};
+        if (fd < 0){
+            throw std::runtime_error{"failed to open " + file_name};
+        }
+        struct stat status{};
+        if (::fstat(fd, &status) != 0){
+            ::close(fd);
+            throw std::runtime_error{"failed to read " + file_name};
+        }
+        m_size = static_cast<std::size_t>(status.st_size);
+        if (m_size > 0){
+            void* address{::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+            if (address == MAP_FAILED){
+                ::close(fd);
+                throw std::runtime_error{"failed to map " + file_name};
+            }
+            ::madvise(address, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(address);
+        }
+        ::close(fd);
+#else
+        std::ifstream file{file_name, std::ios::binary};
+        if (!file){
+            throw std::runtime_error{"failed to open " + file_name};
+        }
+        m_buffer.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file()
+    {
+#if ALGORITHMS_HAS_MMAP
+        if (m_data){
+            ::munmap(const_cast<char*>(m_data), m_size);
+        }
+#endif
+    }
+
+    [[nodiscard]]
+    const char* data() const noexcept
+    {
+        return m_data;
+    }
+
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+private:
+    const char* m_data{};
+    std::size_t m_size{};
+#if !ALGORITHMS_HAS_MMAP
+    std::vector<char> m_buffer;
+#endif
+};
+
+template <algorithm_value_type ValueType>
+[[nodiscard]] std::vector<ValueType> read_binary_input(const mapped_file& file,
+                                                       const std::string& file_name)
+{
+    binary_input_header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    bool swap_bytes{header.endianness != binary_input_header::native_byte_order()};
+    if (swap_bytes){
+        header.count = byte_swapped(header.count);
+    }
+    if (header.kind != binary_input_header::kind_of<ValueType>() ||
+        header.value_size != sizeof(ValueType)){
+        throw std::runtime_error{file_name + " does not hold inputs of the sorted type"};
+    }
+    if (header.count > (file.size() - sizeof(header)) / sizeof(ValueType)){
+        throw std::runtime_error{file_name + " is truncated"};
+    }
+    std::vector<ValueType> vec(header.count);
+    std::memcpy(vec.data(), file.data() + sizeof(header), header.count * sizeof(ValueType));
+    if (swap_bytes){
+        for (auto& value : vec){
+            value = byte_swapped(value);
+        }
+    }
+    return vec;
+}
+
+inline constexpr std::size_t text_input_chunk_size = 1UL << 20;
+
+/* spaces and control characters separate the values of a text input file */
+[[nodiscard]] constexpr bool is_input_separator(char c) noexcept
+{
+    return static_cast<unsigned char>(c) <= ' ';
+}
+
+/* the number of values whose first character lies in [first, last) */
+[[nodiscard]] inline std::size_t
+count_text_values(const char* begin, const char* first, const char* last) noexcept
+{
+    if (first == last){
+        return 0;
+    }
+    std::size_t count{first == begin && !is_input_separator(*first)};
+    const auto size{static_cast<std::size_t>(last - first)};
+    const char* previous{first == begin ? first : first - 1};
+    const char* current{first == begin ? first + 1 : first};
+    const auto pairs{first == begin ? size - 1 : size};
+    for (std::size_t i{}; i < pairs; ++i){
+        count += is_input_separator(previous[i]) & !is_input_separator(current[i]);
+    }
+    return count;
+}
+
+/* parses the values whose first character lies in [first, last), a value may end past last */
+template <algorithm_value_type ValueType>
+void parse_text_values(const char* begin, const char* first, const char* last, const char* end,
+                       ValueType* out, const std::string& file_name)
+{
+    if (first != begin){
+        while (first < last && !is_input_separator(first[-1]) && !is_input_separator(*first)){
+            ++first;
+        }
+    }
+    for (;;){
+        while (first < last && is_input_separator(*first)){
+            ++first;
+        }
+        if (first >= last){
+            return;
+        }
+        const char* value{first};
+        if (*value == '+' && value + 1 != end && !is_input_separator(value[1])){
+            ++value;
+        }
+        auto [next, error]{std::from_chars(value, end, *out)};
+        if (error != std::errc{} || (next != end && !is_input_separator(*next))){
+            auto token_end{std::find_if(first, end, is_input_separator)};
+            throw std::runtime_error{
+                "invalid input \"" + std::string{first, token_end} + "\" in " + file_name
+            };
+        }
+        ++out;
+        first = next;
+    }
+}
+
+template <typename Function>
+void for_each_input_chunk(std::size_t chunk_count, task_pool* pool, Function function)
+{
+    if (pool == nullptr || pool->get_thread_count() == 1 || chunk_count < 2){
+        for (std::size_t i{}; i < chunk_count; ++i){
+            function(i);
+        }
+        return;
+    }
+    task_pool::task_group group{*pool};
+    for (std::size_t i{}; i < chunk_count; ++i){
+        group.run([&function, i](){ function(i); });
+    }
+    group.wait();
+}
+
+/*
+ * the mapped text is split into fixed size chunks, the values starting in
+ * each chunk are counted first so that the vector is allocated once with
+ * its final size and every chunk is parsed straight into its own range.
+ */
+template <algorithm_value_type ValueType>
+[[nodiscard]] std::vector<ValueType> read_text_input(const mapped_file& file,
+                                                     const std::string& file_name,
+                                                     task_pool* pool)
+{
+    const char* begin{file.data()};
+    const char* end{begin + file.size()};
+    auto chunk_count{(file.size() + text_input_chunk_size - 1) / text_input_chunk_size};
+    auto chunk_begin{[begin, &file](std::size_t i){
+        return begin + std::min(i * text_input_chunk_size, file.size());
+    }};
+    std::vector<std::size_t> offsets(chunk_count + 1);
+    for_each_input_chunk(chunk_count, pool, [&](std::size_t i){
+        offsets[i + 1] = count_text_values(begin, chunk_begin(i), chunk_begin(i + 1));
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<ValueType> vec(offsets.back());
+    for_each_input_chunk(chunk_count, pool, [&](std::size_t i){
+        parse_text_values(begin, chunk_begin(i), chunk_begin(i + 1), end,
+                          vec.data() + offsets[i], file_name);
+    });
+    return vec;
+}
+
+/* binary files are recognized by their header, anything else is read as text */
+template <algorithm_value_type ValueType>
+[[nodiscard]] std::vector<ValueType> read_input_file(const std::string& file_name,
+                                                     task_pool* pool = nullptr)
+{
+    mapped_file file{file_name};
+    const auto& magic{binary_input_header::file_magic};
+    if (file.size() >= sizeof(binary_input_header) &&
+        std::equal(magic.begin(), magic.end(), file.data())){
+        return read_binary_input<ValueType>(file, file_name);
+    }
+    return read_text_input<ValueType>(file, file_name, pool);
+}
+
+template <algorithm_value_type ValueType>
+class input_file_writer {
+public:
+    input_file_writer(const std::string& file_name, input_file_format format, std::uint64_t count)
+        : m_file{file_name, std::ios::binary},
+        m_format{format}
+    {
+        if (!m_file){
+            throw std::runtime_error{"failed to create " + file_name};
+        }
+        if (m_format == input_file_format::binary){
+            binary_input_header header;
+            header.kind = binary_input_header::kind_of<ValueType>();
+            header.value_size = sizeof(ValueType);
+            header.endianness = binary_input_header::native_byte_order();
+            header.count = count;
+            m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+    }
+
+    void write(std::span<const ValueType> values)
+    {
+        if (m_format == input_file_format::binary){
+            m_file.write(reinterpret_cast<const char*>(values.data()),
+                         static_cast<std::streamsize>(values.size_bytes()));
+        } else {
+            m_buffer.resize(values.size() * text_value_width);
+            char* first{m_buffer.data()};
+            char* last{first + m_buffer.size()};
+            for (const auto& value : values){
+                first = std::to_chars(first, last, value).ptr;
+                *first++ = '\n';
+            }
+            m_file.write(m_buffer.data(), first - m_buffer.data());
+        }
+    }
+
+    [[nodiscard]]
+    static std::string extension(input_file_format format)
+    {
+        return format == input_file_format::binary ? ".bin" : ".txt";
+    }
+
+private:
+    /* an upper bound of the characters of a value and its separator */
+    static constexpr std::size_t text_value_width = std::floating_point<ValueType> ?
+        std::numeric_limits<ValueType>::max_digits10 + 12 :
+        std::numeric_limits<ValueType>::digits10 + 3;
+
+    std::ofstream m_file;
+    input_file_format m_format;
+    std::vector<char> m_buffer;
+};
+
+} /* namespace algorithms */
+
+#endif /* INPUT_FILE_HPP */
@@ -0,0 +1,162 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef INPUT_SIZE_SWEEP_HPP
+#define INPUT_SIZE_SWEEP_HPP
+
+#include <span>
+#include <cmath>
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <string_view>
+
+namespace algorithms {
+
+/*
+ * parses first:last:xfactor into the geometric series first, first * factor,
+ * ... up to last, or first:last:+step into an arithmetic series. sizes may
+ * be written in scientific notation, 1e3:1e8:x2.
+ */
+[[nodiscard]] inline std::vector<std::int64_t> parse_input_size_sweep(std::string_view sweep)
+{
+    auto invalid = [sweep](){
+        return std::runtime_error{"invalid input size sweep " + std::string{sweep} +
+                                  ", expected first:last:xfactor or first:last:+step"};
+    };
+    auto number = [&](std::string_view str){
+        std::size_t length{};
+        double value{};
+        try {
+            value = std::stod(std::string{str}, &length);
+        } catch (const std::exception&){
+            throw invalid();
+        }
+        if (length != str.size() || !std::isfinite(value)){
+            throw invalid();
+        }
+        return value;
+    };
+    auto first_separator{sweep.find(':')};
+    auto second_separator{sweep.find(':', first_separator + 1)};
+    if (first_separator == std::string_view::npos || second_separator == std::string_view::npos){
+        throw invalid();
+    }
+    auto first{number(sweep.substr(0, first_separator))};
+    auto last{number(sweep.substr(first_separator + 1, second_separator - first_separator - 1))};
+    auto step{sweep.substr(second_separator + 1)};
+    if (step.empty() || (step.front() != 'x' && step.front() != '+')){
+        throw invalid();
+    }
+    auto geometric{step.front() == 'x'};
+    auto increment{number(step.substr(1))};
+    if (last < first){
+        throw std::runtime_error{"the last input size of the sweep cannot be smaller than the first"};
+    }
+    if (first < 1 || last > static_cast<double>(std::numeric_limits<std::int64_t>::max() / 2)){
+        throw std::runtime_error{"input sizes of the sweep must be in [1, " +
+                                 std::to_string(std::numeric_limits<std::int64_t>::max() / 2) + "]"};
+    }
+    if (geometric ? increment <= 1. : increment < 1.){
+        throw std::runtime_error{"the input sizes of the sweep must be increasing"};
+    }
+    std::vector<std::int64_t> sizes;
+    for (auto size{first}; size <= last * (1. + 1e-9); size = geometric ? size * increment : size + increment){
+        auto rounded{std::llround(size)};
+        if (sizes.empty() || rounded > sizes.back()){
+            sizes.push_back(rounded);
+        }
+    }
+    return sizes;
+}
+
+enum class complexity_model {
+    linear, linearithmic, quadratic
+};
+
+inline constexpr std::array complexity_model_names{
+    std::pair{complexity_model::linear,       std::string_view{"n"}},
+    std::pair{complexity_model::linearithmic, std::string_view{"n log n"}},
+    std::pair{complexity_model::quadratic,    std::string_view{"n^2"}}
+};
+
+[[nodiscard]] inline std::string to_string(complexity_model model)
+{
+    for (const auto& [value, name] : complexity_model_names){
+        if (value == model){
+            return std::string{name};
+        }
+    }
+    throw std::runtime_error{"unknown complexity model"};
+}
+
+[[nodiscard]] inline double complexity(complexity_model model, double n) noexcept
+{
+    switch (model){
+    case complexity_model::linear:
+        return n;
+    case complexity_model::linearithmic:
+        return n * std::max(std::log2(n), 1.);
+    case complexity_model::quadratic:
+        return n * n;
+    }
+    return n;
+}
+
+/* time(n) ~ constant * n^exponent, and the model that follows the times closest */
+struct complexity_fit {
+    double exponent;
+    complexity_model model;
+    /* nanoseconds per n, n log2 n or n^2 of the model */
+    double constant;
+};
+
+/*
+ * the exponent is the least squares slope of log time over log n, each model
+ * is scaled by the geometric mean of its ratios to the times and the one with
+ * the smallest squared log residual is chosen, so every size weighs the same
+ * however long it takes. needs at least two different sizes.
+ */
+[[nodiscard]] inline complexity_fit
+fit_complexity(std::span<const std::pair<double, double>> sizes_and_times)
+{
+    const auto count{static_cast<double>(sizes_and_times.size())};
+    double mean_log_n{}, mean_log_time{};
+    for (const auto& [n, time] : sizes_and_times){
+        mean_log_n += std::log(n) / count;
+        mean_log_time += std::log(time) / count;
+    }
+    double covariance{}, variance{};
+    for (const auto& [n, time] : sizes_and_times){
+        covariance += (std::log(n) - mean_log_n) * (std::log(time) - mean_log_time);
+        variance += (std::log(n) - mean_log_n) * (std::log(n) - mean_log_n);
+    }
+    complexity_fit fit{variance > 0 ? covariance / variance : 0., complexity_model::linear, 0.};
+    auto best_residual{std::numeric_limits<double>::infinity()};
+    for (const auto& [model, name] : complexity_model_names){
+        double log_constant{};
+        for (const auto& [n, time] : sizes_and_times){
+            log_constant += (std::log(time) - std::log(complexity(model, n))) / count;
+        }
+        double residual{};
+        for (const auto& [n, time] : sizes_and_times){
+            auto difference{std::log(time) - std::log(complexity(model, n)) - log_constant};
+            residual += difference * difference;
+        }
+        if (residual < best_residual){
+            best_residual = residual;
+            fit.model = model;
+            fit.constant = std::exp(log_constant);
+        }
+    }
+    return fit;
+}
+
+} /* namespace algorithms */
+
+#endif /* INPUT_SIZE_SWEEP_HPP */
@@ -0,0 +1,36 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef OPERATION_COUNTER_HPP
+#define OPERATION_COUNTER_HPP
+
+#include <cstdint>
+#include <concepts>
+
+namespace algorithms {
+
+/*
+ * the algorithms are instantiated with one of two counters. std::uint64_t
+ * counts the comparisons and assignments, null_counter accepts the same
+ * operations and drops them, so the timed runs compile to kernels that do
+ * not touch any counter.
+ */
+struct null_counter {
+    constexpr null_counter& operator++() noexcept
+    {
+        return *this;
+    }
+
+    template <typename T>
+    constexpr null_counter& operator+=(const T&) noexcept
+    {
+        return *this;
+    }
+};
+
+template <typename T>
+concept operation_counter = std::same_as<T, std::uint64_t> || std::same_as<T, null_counter>;
+
+} /* namespace algorithms */
+
+#endif /* OPERATION_COUNTER_HPP */
@@ -0,0 +1,164 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <optional>
+
+#if __has_include(<linux/perf_event.h>)
+#define ALGORITHMS_HAS_PERF_EVENTS 1
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#else
+#define ALGORITHMS_HAS_PERF_EVENTS 0
+#endif
+
+namespace algorithms {
+
+/*
+ * hardware event counters of the calling thread, opened with
+ * perf_event_open on linux. every event is opened on its own, so events the
+ * cpu or the kernel does not support, or that the user is not permitted to
+ * count, are simply left empty. the counts are scaled when the kernel had
+ * to multiplex the events on fewer hardware counters.
+ */
+class perf_counters {
+public:
+    static constexpr std::array event_names{
+        "cycles", "instructions", "branch misses", "L1D misses", "LLC misses", "dTLB misses"
+    };
+    static constexpr std::size_t event_count = event_names.size();
+
+    using values_t = std::array<std::optional<std::uint64_t>, event_count>;
+
+    perf_counters() noexcept
+    {
+#if ALGORITHMS_HAS_PERF_EVENTS
+        constexpr auto cache_miss = [](std::uint64_t cache){
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        const std::array<std::pair<std::uint32_t, std::uint64_t>, event_count> events{{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+            {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB)}
+        }};
+        for (std::size_t i{}; i < event_count; ++i){
+            perf_event_attr attributes{};
+            attributes.size = sizeof(attributes);
+            attributes.type = events[i].first;
+            attributes.config = events[i].second;
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            m_fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1,
+                                                  PERF_FLAG_FD_CLOEXEC));
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    ~perf_counters()
+    {
+#if ALGORITHMS_HAS_PERF_EVENTS
+        for (auto fd : m_fds){
+            if (fd >= 0){
+                ::close(fd);
+            }
+        }
+#endif
+    }
+
+    /* false if none of the events could be opened */
+    [[nodiscard]]
+    bool available() const noexcept
+    {
+        for (auto fd : m_fds){
+            if (fd >= 0){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void reset() noexcept
+    {
+        control(ioctl_request::reset);
+    }
+
+    void start() noexcept
+    {
+        control(ioctl_request::enable);
+    }
+
+    void stop() noexcept
+    {
+        control(ioctl_request::disable);
+    }
+
+    /* the events counted between every start and stop since the last reset */
+    [[nodiscard]]
+    values_t read() const noexcept
+    {
+        values_t values{};
+#if ALGORITHMS_HAS_PERF_EVENTS
+        for (std::size_t i{}; i < event_count; ++i){
+            struct {
+                std::uint64_t value, time_enabled, time_running;
+            } result{};
+            if (m_fds[i] < 0 || ::read(m_fds[i], &result, sizeof(result)) != sizeof(result) ||
+                result.time_running == 0){
+                continue;
+            }
+            values[i] = static_cast<std::uint64_t>(
+                static_cast<long double>(result.value) * result.time_enabled / result.time_running
+            );
+        }
+#endif
+        return values;
+    }
+
+private:
+    enum class ioctl_request {
+        reset, enable, disable
+    };
+
+    std::array<int, event_count> m_fds{-1, -1, -1, -1, -1, -1};
+
+    void control([[maybe_unused]] ioctl_request request) noexcept
+    {
+#if ALGORITHMS_HAS_PERF_EVENTS
+        for (auto fd : m_fds){
+            if (fd < 0){
+                continue;
+            }
+            switch (request){
+            case ioctl_request::reset:
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                break;
+            case ioctl_request::enable:
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                break;
+            case ioctl_request::disable:
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                break;
+            }
+        }
+#endif
+    }
+};
+
+} /* namespace algorithms */
+
+#endif /* PERF_COUNTERS_HPP */
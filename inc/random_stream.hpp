@@ -0,0 +1,94 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef RANDOM_STREAM_HPP
+#define RANDOM_STREAM_HPP
+
+#include <cmath>
+#include <random>
+#include <limits>
+#include <cstdint>
+#include <concepts>
+
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+/*
+ * counter-based random number generator, the i-th number of a stream is the
+ * splitmix64 hash of the stream key and i. any part of a stream can be
+ * generated independently of the others, so the numbers do not depend on
+ * how the work is split between threads.
+ */
+class random_stream {
+public:
+    constexpr random_stream(std::uint64_t seed, std::uint64_t stream_id) noexcept
+        : m_key{mix(seed ^ mix(stream_id))} { }
+
+    [[nodiscard]]
+    constexpr std::uint64_t operator()(std::uint64_t counter) const noexcept
+    {
+        return mix(m_key + counter * golden_gamma);
+    }
+
+    /* maps the counter-th number of the stream uniformly onto [min, max] */
+    template <algorithm_value_type ValueType>
+    [[nodiscard]]
+    constexpr ValueType value(std::uint64_t counter, ValueType min, ValueType max) const noexcept
+    {
+        auto bits{(*this)(counter)};
+        if constexpr (std::integral<ValueType>){
+            using unsigned_t = std::make_unsigned_t<ValueType>;
+            auto range{static_cast<std::uint64_t>(static_cast<unsigned_t>(
+                static_cast<unsigned_t>(max) - static_cast<unsigned_t>(min)
+            ))};
+            if (range == std::numeric_limits<std::uint64_t>::max()){
+                return static_cast<ValueType>(min + static_cast<unsigned_t>(bits));
+            }
+            auto offset{multiply_high(bits, range + 1)};
+            return static_cast<ValueType>(min + static_cast<unsigned_t>(offset));
+        } else {
+            auto unit{static_cast<ValueType>(static_cast<double>(bits >> 11) * 0x1.0p-53)};
+            return std::lerp(min, max, unit);
+        }
+    }
+
+private:
+    static constexpr std::uint64_t golden_gamma = 0x9e3779b97f4a7c15;
+
+    std::uint64_t m_key;
+
+    [[nodiscard]]
+    static constexpr std::uint64_t mix(std::uint64_t x) noexcept
+    {
+        x += golden_gamma;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+        return x ^ (x >> 31);
+    }
+
+    [[nodiscard]]
+    static constexpr std::uint64_t multiply_high(std::uint64_t a, std::uint64_t b) noexcept
+    {
+#ifdef __SIZEOF_INT128__
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+        std::uint64_t a_low{a & 0xffff'ffff}, a_high{a >> 32};
+        std::uint64_t b_low{b & 0xffff'ffff}, b_high{b >> 32};
+        std::uint64_t low{a_low * b_low};
+        std::uint64_t middle_1{a_high * b_low + (low >> 32)};
+        std::uint64_t middle_2{a_low * b_high + (middle_1 & 0xffff'ffff)};
+        return a_high * b_high + (middle_1 >> 32) + (middle_2 >> 32);
+#endif
+    }
+};
+
+[[nodiscard]] inline std::uint64_t random_seed()
+{
+    std::random_device device;
+    return (static_cast<std::uint64_t>(device()) << 32) | device();
+}
+
+} /* namespace algorithms */
+
+#endif /* RANDOM_STREAM_HPP */
@@ -0,0 +1,510 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef RANGE_ALGORITHMS_HPP
+#define RANGE_ALGORITHMS_HPP
+
+#include <bit>
+#include <cmath>
+#include <span>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <concepts>
+#include <algorithm>
+#include <functional>
+
+#include <tim_sort.hpp>
+#include <operation_counter.hpp>
+
+/*
+ * sorting and selection algorithms over random access iterators and ranges
+ * of any element type, ordered by a comparator of projected elements in the
+ * style of std::ranges. every algorithm is a function object, the ones in
+ * this namespace do not count anything and compile to the same loops as
+ * code written for one element type. instrumented(algorithm, comparison,
+ * assignment) returns the same algorithm adding its comparisons and
+ * assignments to the given counters, a swap counts as two assignments like
+ * in the benchmarked kernels.
+ */
+namespace algorithms::ranges {
+
+namespace detail {
+
+inline constexpr std::ptrdiff_t insertion_sort_cutoff = 16;
+/* larger ranges take the pivot of a selection from a sample around the nth element */
+inline constexpr std::ptrdiff_t floyd_rivest_cutoff = 600;
+
+template <typename Comp, typename Proj, operation_counter Counter>
+struct order {
+    Comp& comp;
+    Proj& proj;
+    Counter& comparison;
+    Counter& assignment;
+
+    template <typename T, typename U>
+    [[nodiscard]] bool less(T&& a, U&& b) const
+    {
+        ++comparison;
+        return std::invoke(comp, std::invoke(proj, std::forward<T>(a)), std::invoke(proj, std::forward<U>(b)));
+    }
+
+    template <std::random_access_iterator I>
+    void swap(I a, I b) const
+    {
+        assignment += 2;
+        std::ranges::iter_swap(a, b);
+    }
+};
+
+template <typename I, typename Order>
+void insertion_sort(I first, I last, const Order& order)
+{
+    if (first == last){
+        return;
+    }
+    for (auto i{first + 1}; i != last; ++i){
+        if (!order.less(*i, *(i - 1))){
+            continue;
+        }
+        std::iter_value_t<I> value{std::ranges::iter_move(i)};
+        auto j{i};
+        do {
+            *j = std::ranges::iter_move(j - 1);
+            ++order.assignment;
+            --j;
+        } while (j != first && order.less(value, *(j - 1)));
+        *j = std::move(value);
+        order.assignment += 2;
+    }
+}
+
+/* sifts the i-th node of the heap in [first, first + size) down, the largest element is at first */
+template <typename I, typename Order>
+void sift_down(I first, std::iter_difference_t<I> size, std::iter_difference_t<I> i, const Order& order)
+{
+    for (;;){
+        auto largest{i};
+        auto left{2 * i + 1};
+        auto right{2 * i + 2};
+        if (left < size && order.less(first[largest], first[left])){
+            largest = left;
+        }
+        if (right < size && order.less(first[largest], first[right])){
+            largest = right;
+        }
+        if (largest == i){
+            return;
+        }
+        order.swap(first + i, first + largest);
+        i = largest;
+    }
+}
+
+template <typename I, typename Order>
+void make_heap(I first, I last, const Order& order)
+{
+    auto size{last - first};
+    for (auto i{size / 2 - 1}; i >= 0; --i){
+        detail::sift_down(first, size, i, order);
+    }
+}
+
+template <typename I, typename Order>
+void sort_heap(I first, I last, const Order& order)
+{
+    for (auto i{last - first - 1}; i > 0; --i){
+        order.swap(first, first + i);
+        detail::sift_down(first, i, decltype(i){}, order);
+    }
+}
+
+/* leaves the middle - first first elements in [first, middle) as a heap, the largest of them at first */
+template <typename I, typename Order>
+void heap_select(I first, I middle, I last, const Order& order)
+{
+    if (first == middle){
+        return;
+    }
+    detail::make_heap(first, middle, order);
+    for (auto i{middle}; i != last; ++i){
+        if (order.less(*i, *first)){
+            order.swap(i, first);
+            detail::sift_down(first, middle - first, decltype(middle - first){}, order);
+        }
+    }
+}
+
+/* moves the median of the first, middle and last elements to first, needs three elements */
+template <typename I, typename Order>
+void median_of_three_to_front(I first, I last, const Order& order)
+{
+    auto a{first + 1};
+    auto b{first + (last - first) / 2};
+    auto c{last - 1};
+    if (order.less(*b, *a)){
+        order.swap(a, b);
+    }
+    if (order.less(*c, *b)){
+        order.swap(b, c);
+        if (order.less(*b, *a)){
+            order.swap(a, b);
+        }
+    }
+    order.swap(first, b);
+}
+
+/*
+ * partitions around the pivot at first and returns its final position.
+ * both scans stop at elements equal to the pivot, so ranges of equal
+ * elements are split in the middle.
+ */
+template <typename I, typename Order>
+[[nodiscard]] I partition(I first, I last, const Order& order)
+{
+    auto i{first + 1};
+    auto j{last - 1};
+    for (;;){
+        while (i <= j && order.less(*i, *first)){
+            ++i;
+        }
+        while (i <= j && order.less(*first, *j)){
+            --j;
+        }
+        if (i >= j){
+            break;
+        }
+        order.swap(i++, j--);
+    }
+    order.swap(first, j);
+    return j;
+}
+
+template <typename I>
+[[nodiscard]] std::iter_difference_t<I> depth_limit(I first, I last) noexcept
+{
+    return 2 * std::bit_width(static_cast<std::uint64_t>(last - first));
+}
+
+template <typename I, typename Order>
+void intro_sort(I first, I last, std::iter_difference_t<I> depth, const Order& order)
+{
+    while (last - first > insertion_sort_cutoff){
+        if (depth-- == 0){
+            detail::make_heap(first, last, order);
+            detail::sort_heap(first, last, order);
+            return;
+        }
+        detail::median_of_three_to_front(first, last, order);
+        auto pivot{detail::partition(first, last, order)};
+        if (pivot - first < last - pivot){
+            detail::intro_sort(first, pivot, depth, order);
+            first = pivot + 1;
+        } else {
+            detail::intro_sort(pivot + 1, last, depth, order);
+            last = pivot;
+        }
+    }
+    detail::insertion_sort(first, last, order);
+}
+
+/*
+ * quickselect that keeps only the side holding nth. the pivot of a large
+ * range is the element selected at nth from a sample around nth, as in
+ * floyd and rivest's algorithm, so the partition leaves nth close to the
+ * pivot and the range shrinks to about the sample size. ranges that still
+ * go too deep fall back to a heap selection.
+ */
+template <typename I, typename Order>
+void intro_select(I first, I nth, I last, std::iter_difference_t<I> depth, const Order& order)
+{
+    while (last - first > insertion_sort_cutoff){
+        if (depth-- == 0){
+            detail::heap_select(first, nth + 1, last, order);
+            order.swap(first, nth);
+            return;
+        }
+        auto size{last - first};
+        if (size > floyd_rivest_cutoff){
+            auto n{static_cast<double>(size)};
+            auto i{static_cast<double>(nth - first)};
+            auto z{std::log(n)};
+            auto s{0.5 * std::exp(2. * z / 3.)};
+            auto sd{0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2. ? -1. : 1.)};
+            auto left{static_cast<std::iter_difference_t<I>>(std::clamp(i - i * s / n + sd, 0., i))};
+            auto right{static_cast<std::iter_difference_t<I>>(std::clamp(i + (n - i) * s / n + sd, i, n - 1.))};
+            detail::intro_select(first + left, nth, first + right + 1, depth, order);
+            order.swap(first, nth);
+        } else {
+            detail::median_of_three_to_front(first, last, order);
+        }
+        auto pivot{detail::partition(first, last, order)};
+        if (pivot == nth){
+            return;
+        }
+        if (pivot < nth){
+            first = pivot + 1;
+        } else {
+            last = pivot;
+        }
+    }
+    detail::insertion_sort(first, last, order);
+}
+
+} /* namespace detail */
+
+/* the counters an algorithm adds to, null_counter drops them without storing anything */
+template <operation_counter Counter>
+class counted_algorithm {
+public:
+    constexpr counted_algorithm(Counter& comparison, Counter& assignment) noexcept
+        : m_comparison{&comparison},
+        m_assignment{&assignment} { }
+
+protected:
+    template <typename Comp, typename Proj>
+    [[nodiscard]] detail::order<Comp, Proj, Counter> order(Comp& comp, Proj& proj) const noexcept
+    {
+        return {comp, proj, *m_comparison, *m_assignment};
+    }
+
+private:
+    Counter* m_comparison;
+    Counter* m_assignment;
+};
+
+template <>
+class counted_algorithm<null_counter> {
+public:
+    constexpr counted_algorithm() noexcept = default;
+
+    constexpr counted_algorithm(null_counter&, null_counter&) noexcept { }
+
+protected:
+    template <typename Comp, typename Proj>
+    [[nodiscard]] detail::order<Comp, Proj, null_counter> order(Comp& comp, Proj& proj) const noexcept
+    {
+        return {comp, proj, m_counter, m_counter};
+    }
+
+private:
+    inline static null_counter m_counter{};
+};
+
+/* sorts like std::ranges::sort, an intro sort that falls back to heap sort */
+template <operation_counter Counter = null_counter>
+struct sort_fn : counted_algorithm<Counter> {
+    using counted_algorithm<Counter>::counted_algorithm;
+
+    template <std::random_access_iterator I, std::sentinel_for<I> S,
+              typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<I, Comp, Proj>
+    I operator()(I first, S last, Comp comp = {}, Proj proj = {}) const
+    {
+        auto end{std::ranges::next(first, last)};
+        detail::intro_sort(first, end, detail::depth_limit(first, end), this->order(comp, proj));
+        return end;
+    }
+
+    template <std::ranges::random_access_range R, typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Comp, Proj>
+    std::ranges::borrowed_iterator_t<R> operator()(R&& r, Comp comp = {}, Proj proj = {}) const
+    {
+        return (*this)(std::ranges::begin(r), std::ranges::end(r), std::move(comp), std::move(proj));
+    }
+};
+
+template <operation_counter Counter = null_counter>
+struct heap_sort_fn : counted_algorithm<Counter> {
+    using counted_algorithm<Counter>::counted_algorithm;
+
+    template <std::random_access_iterator I, std::sentinel_for<I> S,
+              typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<I, Comp, Proj>
+    I operator()(I first, S last, Comp comp = {}, Proj proj = {}) const
+    {
+        auto end{std::ranges::next(first, last)};
+        auto order{this->order(comp, proj)};
+        detail::make_heap(first, end, order);
+        detail::sort_heap(first, end, order);
+        return end;
+    }
+
+    template <std::ranges::random_access_range R, typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Comp, Proj>
+    std::ranges::borrowed_iterator_t<R> operator()(R&& r, Comp comp = {}, Proj proj = {}) const
+    {
+        return (*this)(std::ranges::begin(r), std::ranges::end(r), std::move(comp), std::move(proj));
+    }
+};
+
+/*
+ * sorts like std::ranges::stable_sort, the adaptive merge sort of tim_sorter.
+ * it merges through a buffer of raw elements, so it takes contiguous ranges.
+ */
+template <operation_counter Counter = null_counter>
+struct stable_sort_fn : counted_algorithm<Counter> {
+    using counted_algorithm<Counter>::counted_algorithm;
+
+    template <std::contiguous_iterator I, std::sentinel_for<I> S,
+              typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<I, Comp, Proj>
+    I operator()(I first, S last, Comp comp = {}, Proj proj = {}) const
+    {
+        auto end{std::ranges::next(first, last)};
+        using value_t = std::iter_value_t<I>;
+        tim_sorter<value_t, Counter, std::allocator<value_t>, Comp, Proj> sorter{comp, proj};
+        sorter.sort(std::span<value_t>{std::to_address(first), static_cast<std::size_t>(end - first)});
+        auto order{this->order(comp, proj)};
+        order.comparison += sorter.get_comparison_count();
+        order.assignment += sorter.get_assignment_count();
+        return end;
+    }
+
+    template <std::ranges::contiguous_range R, typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Comp, Proj>
+    std::ranges::borrowed_iterator_t<R> operator()(R&& r, Comp comp = {}, Proj proj = {}) const
+    {
+        return (*this)(std::ranges::begin(r), std::ranges::end(r), std::move(comp), std::move(proj));
+    }
+};
+
+template <operation_counter Counter = null_counter>
+struct insertion_sort_fn : counted_algorithm<Counter> {
+    using counted_algorithm<Counter>::counted_algorithm;
+
+    template <std::random_access_iterator I, std::sentinel_for<I> S,
+              typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<I, Comp, Proj>
+    I operator()(I first, S last, Comp comp = {}, Proj proj = {}) const
+    {
+        auto end{std::ranges::next(first, last)};
+        detail::insertion_sort(first, end, this->order(comp, proj));
+        return end;
+    }
+
+    template <std::ranges::random_access_range R, typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Comp, Proj>
+    std::ranges::borrowed_iterator_t<R> operator()(R&& r, Comp comp = {}, Proj proj = {}) const
+    {
+        return (*this)(std::ranges::begin(r), std::ranges::end(r), std::move(comp), std::move(proj));
+    }
+};
+
+/* the algorithms below take a position in the range, nth or middle, and differ in how they order around it */
+template <typename Algorithm>
+struct positioned_algorithm {
+    template <std::ranges::random_access_range R, typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Comp, Proj>
+    std::ranges::borrowed_iterator_t<R>
+    operator()(R&& r, std::ranges::iterator_t<R> position, Comp comp = {}, Proj proj = {}) const
+    {
+        return static_cast<const Algorithm&>(*this)(
+            std::ranges::begin(r), position, std::ranges::end(r), std::move(comp), std::move(proj)
+        );
+    }
+};
+
+/*
+ * like std::ranges::nth_element, the element at nth is the one a sort
+ * would put there and no element before it is greater than any after it.
+ */
+template <operation_counter Counter = null_counter>
+struct nth_element_fn : counted_algorithm<Counter>, positioned_algorithm<nth_element_fn<Counter>> {
+    using counted_algorithm<Counter>::counted_algorithm;
+    using positioned_algorithm<nth_element_fn<Counter>>::operator();
+
+    template <std::random_access_iterator I, std::sentinel_for<I> S,
+              typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<I, Comp, Proj>
+    I operator()(I first, I nth, S last, Comp comp = {}, Proj proj = {}) const
+    {
+        auto end{std::ranges::next(first, last)};
+        if (nth != end){
+            detail::intro_select(first, nth, end, detail::depth_limit(first, end), this->order(comp, proj));
+        }
+        return end;
+    }
+};
+
+/* like std::ranges::partial_sort, the middle - first first elements are selected with a heap and sorted */
+template <operation_counter Counter = null_counter>
+struct partial_sort_fn : counted_algorithm<Counter>, positioned_algorithm<partial_sort_fn<Counter>> {
+    using counted_algorithm<Counter>::counted_algorithm;
+    using positioned_algorithm<partial_sort_fn<Counter>>::operator();
+
+    template <std::random_access_iterator I, std::sentinel_for<I> S,
+              typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<I, Comp, Proj>
+    I operator()(I first, I middle, S last, Comp comp = {}, Proj proj = {}) const
+    {
+        auto end{std::ranges::next(first, last)};
+        auto order{this->order(comp, proj)};
+        detail::heap_select(first, middle, end, order);
+        detail::sort_heap(first, middle, order);
+        return end;
+    }
+};
+
+/*
+ * moves the middle - first first elements of the order to [first, middle)
+ * in no particular order. the heap version keeps them in a heap while it
+ * reads the range once, which suits small k, the quickselect version
+ * partitions around the last of them.
+ */
+template <operation_counter Counter = null_counter>
+struct heap_top_k_fn : counted_algorithm<Counter>, positioned_algorithm<heap_top_k_fn<Counter>> {
+    using counted_algorithm<Counter>::counted_algorithm;
+    using positioned_algorithm<heap_top_k_fn<Counter>>::operator();
+
+    template <std::random_access_iterator I, std::sentinel_for<I> S,
+              typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<I, Comp, Proj>
+    I operator()(I first, I middle, S last, Comp comp = {}, Proj proj = {}) const
+    {
+        auto end{std::ranges::next(first, last)};
+        detail::heap_select(first, middle, end, this->order(comp, proj));
+        return end;
+    }
+};
+
+template <operation_counter Counter = null_counter>
+struct top_k_fn : counted_algorithm<Counter>, positioned_algorithm<top_k_fn<Counter>> {
+    using counted_algorithm<Counter>::counted_algorithm;
+    using positioned_algorithm<top_k_fn<Counter>>::operator();
+
+    template <std::random_access_iterator I, std::sentinel_for<I> S,
+              typename Comp = std::ranges::less, typename Proj = std::identity>
+    requires std::sortable<I, Comp, Proj>
+    I operator()(I first, I middle, S last, Comp comp = {}, Proj proj = {}) const
+    {
+        auto end{std::ranges::next(first, last)};
+        if (first != middle){
+            detail::intro_select(first, middle - 1, end, detail::depth_limit(first, end), this->order(comp, proj));
+        }
+        return end;
+    }
+};
+
+inline constexpr sort_fn<> sort{};
+inline constexpr heap_sort_fn<> heap_sort{};
+inline constexpr stable_sort_fn<> stable_sort{};
+inline constexpr insertion_sort_fn<> insertion_sort{};
+inline constexpr nth_element_fn<> nth_element{};
+inline constexpr partial_sort_fn<> partial_sort{};
+inline constexpr heap_top_k_fn<> heap_top_k{};
+inline constexpr top_k_fn<> top_k{};
+
+/* the given algorithm counting into comparison and assignment */
+template <template <typename> typename Algorithm, operation_counter Counter>
+[[nodiscard]] constexpr Algorithm<Counter>
+instrumented(const Algorithm<null_counter>&, Counter& comparison, Counter& assignment) noexcept
+{
+    return Algorithm<Counter>{comparison, assignment};
+}
+
+} /* namespace algorithms::ranges */
+
+#endif /* RANGE_ALGORITHMS_HPP */
@@ -0,0 +1,188 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef RECORD_SORT_HPP
+#define RECORD_SORT_HPP
+
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <utility>
+#include <stdexcept>
+#include <charconv>
+#include <algorithm>
+#include <string_view>
+
+#include <operation_counter.hpp>
+#include <range_algorithms.hpp>
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+/* a key and the bytes that travel with it */
+template <algorithm_value_type Key, std::size_t PayloadSize>
+struct record {
+    Key key;
+    std::array<std::byte, PayloadSize> payload;
+};
+
+/* the payload sizes records can be benchmarked with */
+inline constexpr std::array<std::size_t, 6> record_payload_sizes{8, 16, 32, 64, 128, 256};
+
+/* parses a comma separated list of payload sizes in bytes, "all" selects every size */
+[[nodiscard]] inline std::vector<std::size_t> parse_record_payload_sizes(std::string_view sizes)
+{
+    std::vector<std::size_t> payload_sizes;
+    while (!sizes.empty()){
+        auto separator{sizes.find(',')};
+        auto size{sizes.substr(0, separator)};
+        sizes = separator == std::string_view::npos ? std::string_view{} : sizes.substr(separator + 1);
+        if (size == "all"){
+            payload_sizes.assign(record_payload_sizes.begin(), record_payload_sizes.end());
+            continue;
+        }
+        std::size_t payload_size{};
+        auto [end, error]{std::from_chars(size.data(), size.data() + size.size(), payload_size)};
+        if (error != std::errc{} || end != size.data() + size.size() ||
+            std::find(record_payload_sizes.begin(), record_payload_sizes.end(), payload_size) ==
+            record_payload_sizes.end()){
+            throw std::runtime_error{"invalid payload size " + std::string{size} +
+                                     ", expected 8, 16, 32, 64, 128 or 256"};
+        }
+        payload_sizes.push_back(payload_size);
+    }
+    if (payload_sizes.empty()){
+        throw std::runtime_error{"no payload size is selected"};
+    }
+    return payload_sizes;
+}
+
+/*
+ * argsort sorts (key, index) pairs and moves every record once into its
+ * place by following the cycles of the permutation, pointers sorts (key,
+ * pointer) pairs and gathers the records into a second array, structs
+ * sorts the records themselves. the pairs are ordered by the index or the
+ * address of the record after the key, so the first two are stable.
+ */
+enum class record_layout {
+    argsort, pointers, structs
+};
+
+inline constexpr std::array record_layout_names{
+    std::pair{record_layout::argsort,  std::string_view{"argsort"}},
+    std::pair{record_layout::pointers, std::string_view{"pointers"}},
+    std::pair{record_layout::structs,  std::string_view{"structs"}}
+};
+
+[[nodiscard]] inline std::string to_string(record_layout layout)
+{
+    for (const auto& [value, name] : record_layout_names){
+        if (value == layout){
+            return std::string{name};
+        }
+    }
+    throw std::runtime_error{"unknown record layout"};
+}
+
+/* the scratch arrays of the layouts, kept between runs so that the timed runs do not allocate them */
+template <typename Record>
+struct record_sort_scratch {
+    using key_t = decltype(Record::key);
+    std::vector<std::pair<key_t, std::uint32_t>> indices;
+    std::vector<std::pair<key_t, const Record*>> pointers;
+    std::vector<Record> records;
+};
+
+/*
+ * sorts the records by key with the given layout. comparison and assignment
+ * count the operations on every array, bytes counts the bytes they moved,
+ * a pair or a record for every assignment.
+ */
+template <operation_counter Counter, typename Record>
+void sort_records(record_layout layout, std::vector<Record>& records, record_sort_scratch<Record>& scratch,
+                  Counter& comparison, Counter& assignment, Counter& bytes)
+{
+    const auto size{records.size()};
+    auto add_bytes = [&bytes](const Counter& count, std::size_t element_size){
+        if constexpr (std::same_as<Counter, std::uint64_t>){
+            bytes += count * element_size;
+        }
+    };
+    switch (layout){
+    case record_layout::argsort: {
+        if (size > std::numeric_limits<std::uint32_t>::max()){
+            throw std::runtime_error{"argsort supports at most " +
+                                     std::to_string(std::numeric_limits<std::uint32_t>::max()) + " records"};
+        }
+        auto& indices{scratch.indices};
+        indices.resize(size);
+        for (std::uint32_t i{}; i < size; ++i){
+            indices[i] = {records[i].key, i};
+        }
+        Counter pair_assignment{};
+        ranges::instrumented(ranges::sort, comparison, pair_assignment)(indices);
+        pair_assignment += size;
+        Counter record_assignment{};
+        for (std::uint32_t i{}; i < size; ++i){
+            if (indices[i].second == i){
+                continue;
+            }
+            Record displaced{std::move(records[i])};
+            auto j{i};
+            for (;;){
+                auto source{std::exchange(indices[j].second, j)};
+                if (source == i){
+                    records[j] = std::move(displaced);
+                    break;
+                }
+                records[j] = std::move(records[source]);
+                ++record_assignment;
+                j = source;
+            }
+            record_assignment += 2;
+        }
+        assignment += pair_assignment;
+        assignment += record_assignment;
+        add_bytes(pair_assignment, sizeof(indices.front()));
+        add_bytes(record_assignment, sizeof(Record));
+        break;
+    }
+    case record_layout::pointers: {
+        auto& pointers{scratch.pointers};
+        pointers.resize(size);
+        for (std::size_t i{}; i < size; ++i){
+            pointers[i] = {records[i].key, &records[i]};
+        }
+        Counter pair_assignment{};
+        ranges::instrumented(ranges::sort, comparison, pair_assignment)(pointers);
+        pair_assignment += size;
+        scratch.records.resize(size);
+        for (std::size_t i{}; i < size; ++i){
+            scratch.records[i] = *pointers[i].second;
+        }
+        std::swap(records, scratch.records);
+        Counter record_assignment{};
+        record_assignment += size;
+        assignment += pair_assignment;
+        assignment += record_assignment;
+        add_bytes(pair_assignment, sizeof(pointers.front()));
+        add_bytes(record_assignment, sizeof(Record));
+        break;
+    }
+    case record_layout::structs: {
+        Counter record_assignment{};
+        ranges::instrumented(ranges::sort, comparison, record_assignment)(records, {}, &Record::key);
+        assignment += record_assignment;
+        add_bytes(record_assignment, sizeof(Record));
+        break;
+    }
+    }
+}
+
+} /* namespace algorithms */
+
+#endif /* RECORD_SORT_HPP */
@@ -0,0 +1,448 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef RESULT_EXPORT_HPP
+#define RESULT_EXPORT_HPP
+
+#include <span>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <utility>
+#include <fstream>
+#include <concepts>
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+#include <algorithm_comparison_table.hpp>
+
+namespace algorithms {
+
+enum class result_format {
+    table, json, csv
+};
+
+[[nodiscard]] inline result_format parse_result_format(std::string_view name)
+{
+    if (name == "table"){
+        return result_format::table;
+    }
+    if (name == "json"){
+        return result_format::json;
+    }
+    if (name == "csv"){
+        return result_format::csv;
+    }
+    throw std::runtime_error{"unknown result format " + std::string{name}};
+}
+
+/* the hardware event names as json keys and csv headers, "branch misses" becomes "branch_misses" */
+[[nodiscard]] inline std::string result_field_name(std::string_view name)
+{
+    std::string field;
+    for (auto c : name){
+        field += c == ' ' ? '_' : static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    }
+    return field;
+}
+
+namespace result_export_detail {
+
+[[nodiscard]] inline std::string json_string(std::string_view str)
+{
+    std::string quoted{"\""};
+    for (auto c : str){
+        if (c == '"' || c == '\\'){
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < ' '){
+            quoted += std::format("\\u{:04x}", static_cast<unsigned>(c));
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+/* the numbers that have no value, an undefined speedup or error, are written as null in json and empty in csv */
+template <typename T>
+[[nodiscard]] std::string number(const std::optional<T>& value, std::string_view none)
+{
+    if (!value){
+        return std::string{none};
+    }
+    if constexpr (std::floating_point<T>){
+        return std::format("{:.6g}", *value);
+    } else {
+        return std::to_string(*value);
+    }
+}
+
+[[nodiscard]] inline std::optional<double> finite(double value) noexcept
+{
+    return std::isfinite(value) ? std::optional{value} : std::nullopt;
+}
+
+[[nodiscard]] inline std::optional<double> speedup(double value) noexcept
+{
+    return value > 0 ? std::optional{value} : std::nullopt;
+}
+
+/*
+ * reads the json written by results_to_json, the parser accepts any json
+ * but only keeps the strings and numbers of the objects in "results".
+ */
+class json_reader {
+public:
+    using fields_t = std::vector<std::pair<std::string, std::optional<std::string>>>;
+
+    explicit json_reader(std::string_view text) noexcept
+        : m_text{text} { }
+
+    [[nodiscard]]
+    std::vector<fields_t> results()
+    {
+        std::vector<fields_t> objects;
+        expect('{');
+        if (!consume('}')){
+            do {
+                auto key{string()};
+                expect(':');
+                if (key != "results"){
+                    skip_value();
+                    continue;
+                }
+                expect('[');
+                if (consume(']')){
+                    continue;
+                }
+                do {
+                    objects.push_back(flat_object());
+                } while (consume(','));
+                expect(']');
+            } while (consume(','));
+            expect('}');
+        }
+        return objects;
+    }
+
+private:
+    std::string_view m_text;
+    std::size_t m_position{};
+
+    [[noreturn]] void fail() const
+    {
+        throw std::runtime_error{"invalid json at offset " + std::to_string(m_position)};
+    }
+
+    char peek()
+    {
+        while (m_position < m_text.size() && std::string_view{" \t\r\n"}.find(m_text[m_position]) != std::string_view::npos){
+            ++m_position;
+        }
+        return m_position < m_text.size() ? m_text[m_position] : '\0';
+    }
+
+    bool consume(char c)
+    {
+        if (peek() == c){
+            ++m_position;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!consume(c)){
+            fail();
+        }
+    }
+
+    std::string string()
+    {
+        expect('"');
+        std::string str;
+        while (m_position < m_text.size() && m_text[m_position] != '"'){
+            auto c{m_text[m_position++]};
+            if (c == '\\'){
+                if (m_position >= m_text.size()){
+                    fail();
+                }
+                c = m_text[m_position++];
+                if (c == 'u'){
+                    unsigned code{};
+                    auto [end, error] = std::from_chars(m_text.data() + m_position,
+                                                        m_text.data() + std::min(m_position + 4, m_text.size()), code, 16);
+                    if (error != std::errc{} || end != m_text.data() + m_position + 4 || code > 0x7f){
+                        fail();
+                    }
+                    m_position += 4;
+                    c = static_cast<char>(code);
+                } else if (c == 'n'){
+                    c = '\n';
+                } else if (c == 't'){
+                    c = '\t';
+                } else if (c == 'r'){
+                    c = '\r';
+                }
+            }
+            str += c;
+        }
+        expect('"');
+        return str;
+    }
+
+    /* a number or a literal, returned as written, null is returned empty */
+    std::optional<std::string> scalar()
+    {
+        peek();
+        auto first{m_position};
+        while (m_position < m_text.size() && std::string_view{",}] \t\r\n"}.find(m_text[m_position]) == std::string_view::npos){
+            ++m_position;
+        }
+        if (first == m_position){
+            fail();
+        }
+        auto token{m_text.substr(first, m_position - first)};
+        if (token == "null"){
+            return std::nullopt;
+        }
+        return std::string{token};
+    }
+
+    void skip_value()
+    {
+        auto c{peek()};
+        if (c == '"'){
+            (void)string();
+        } else if (c == '{' || c == '['){
+            auto close{c == '{' ? '}' : ']'};
+            ++m_position;
+            if (consume(close)){
+                return;
+            }
+            do {
+                if (c == '{'){
+                    (void)string();
+                    expect(':');
+                }
+                skip_value();
+            } while (consume(','));
+            expect(close);
+        } else {
+            (void)scalar();
+        }
+    }
+
+    fields_t flat_object()
+    {
+        fields_t fields;
+        expect('{');
+        if (consume('}')){
+            return fields;
+        }
+        do {
+            auto key{string()};
+            expect(':');
+            auto c{peek()};
+            if (c == '"'){
+                fields.emplace_back(std::move(key), string());
+            } else if (c == '{' || c == '['){
+                skip_value();
+            } else {
+                fields.emplace_back(std::move(key), scalar());
+            }
+        } while (consume(','));
+        expect('}');
+        return fields;
+    }
+};
+
+} /* namespace result_export_detail */
+
+/* one object per row of the table, times are in nanoseconds */
+[[nodiscard]] inline std::string
+results_to_json(std::span<const algorithm_comparison_table::test_results_t> results, std::uint64_t seed)
+{
+    using namespace result_export_detail;
+    std::string json{std::format("{{\n  \"seed\": {},\n  \"results\": [", seed)};
+    for (std::size_t i{}; i < results.size(); ++i){
+        const auto& [
+            algorithm_name, distribution, input_size, test_count, comparison, assignment, allocation,
+            median_time, avg_time, speedup_value, memory_traffic, hardware_counters, statistics, cpu_share,
+            external_times
+        ] = results[i];
+        json += (i == 0 ? "\n" : ",\n");
+        json += std::format(
+            "    {{\"algorithm\": {}, \"distribution\": {}, \"input_size\": {}, \"test_count\": {}, "
+            "\"comparisons\": {}, \"assignments\": {}, \"allocations\": {}, "
+            "\"median_ns\": {}, \"mean_ns\": {}, \"min_ns\": {}, \"p90_ns\": {}, \"p99_ns\": {}, \"stddev_ns\": {}, "
+            "\"outliers\": {}, \"relative_error\": {}, \"speedup\": {}, \"cpu_share\": {}, \"io_ns\": {}, \"cpu_ns\": {}, ",
+            json_string(algorithm_name), json_string(distribution), input_size, test_count,
+            comparison, assignment, allocation,
+            median_time.count(), avg_time.count(), statistics.min.count(), statistics.p90.count(),
+            statistics.p99.count(), statistics.stddev.count(), statistics.outliers,
+            number(finite(statistics.relative_error), "null"), number(speedup(speedup_value), "null"),
+            number(cpu_share, "null"),
+            external_times ? std::to_string(external_times->io.count()) : "null",
+            external_times ? std::to_string(external_times->cpu.count()) : "null"
+        );
+        if (memory_traffic){
+            json += std::format("\"memory_traffic\": {{\"passes\": {:.6g}, \"bytes\": {}}}, ",
+                                memory_traffic->passes, memory_traffic->bytes);
+        } else {
+            json += "\"memory_traffic\": null, ";
+        }
+        json += "\"hardware_counters\": {";
+        for (std::size_t event{}; event < perf_counters::event_count; ++event){
+            json += std::format("{}{}: {}", event == 0 ? "" : ", ",
+                                json_string(result_field_name(perf_counters::event_names[event])),
+                                number(hardware_counters[event], "null"));
+        }
+        json += "}}";
+    }
+    return json + "\n  ]\n}\n";
+}
+
+/* one line per row of the table, empty fields have no value */
+[[nodiscard]] inline std::string
+results_to_csv(std::span<const algorithm_comparison_table::test_results_t> results)
+{
+    using namespace result_export_detail;
+    std::string csv{
+        "algorithm,distribution,input_size,test_count,comparisons,assignments,allocations,"
+        "median_ns,mean_ns,min_ns,p90_ns,p99_ns,stddev_ns,outliers,relative_error,speedup,cpu_share,io_ns,cpu_ns,"
+        "passes,memory_bytes"
+    };
+    for (const auto& name : perf_counters::event_names){
+        csv += "," + result_field_name(name);
+    }
+    csv += "\n";
+    for (const auto& [
+            algorithm_name, distribution, input_size, test_count, comparison, assignment, allocation,
+            median_time, avg_time, speedup_value, memory_traffic, hardware_counters, statistics, cpu_share,
+            external_times
+        ] : results){
+        csv += std::format(
+            "{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{}",
+            algorithm_name, distribution, input_size, test_count, comparison, assignment, allocation,
+            median_time.count(), avg_time.count(), statistics.min.count(), statistics.p90.count(),
+            statistics.p99.count(), statistics.stddev.count(), statistics.outliers,
+            number(finite(statistics.relative_error), ""), number(speedup(speedup_value), ""),
+            number(cpu_share, ""),
+            external_times ? std::to_string(external_times->io.count()) : "",
+            external_times ? std::to_string(external_times->cpu.count()) : "",
+            memory_traffic ? std::format("{:.6g}", memory_traffic->passes) : "",
+            memory_traffic ? std::to_string(memory_traffic->bytes) : ""
+        );
+        for (const auto& count : hardware_counters){
+            csv += "," + number(count, "");
+        }
+        csv += "\n";
+    }
+    return csv;
+}
+
+/* the median time of a row of a stored run and the relative half width of its confidence interval */
+struct baseline_result {
+    algorithm_comparison_table::algorithm_name_t algorithm;
+    algorithm_comparison_table::distribution_t distribution;
+    algorithm_comparison_table::input_size_t input_size;
+    double median_ns;
+    double relative_error;
+};
+
+[[nodiscard]] inline std::vector<baseline_result> read_baseline(const std::string& file_name)
+{
+    std::ifstream file{file_name, std::ios::binary};
+    if (!file){
+        throw std::runtime_error{"failed to open " + file_name};
+    }
+    std::string text{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    std::vector<baseline_result> baseline;
+    try {
+        for (const auto& fields : result_export_detail::json_reader{text}.results()){
+            baseline_result result{{}, {}, -1, -1., std::numeric_limits<double>::infinity()};
+            for (const auto& [key, value] : fields){
+                if (!value){
+                    continue;
+                }
+                if (key == "algorithm"){
+                    result.algorithm = *value;
+                } else if (key == "distribution"){
+                    result.distribution = *value;
+                } else if (key == "input_size"){
+                    result.input_size = std::stoll(*value);
+                } else if (key == "median_ns"){
+                    result.median_ns = std::stod(*value);
+                } else if (key == "relative_error"){
+                    result.relative_error = std::stod(*value);
+                }
+            }
+            if (result.algorithm.empty() || result.input_size < 0 || result.median_ns < 0){
+                throw std::runtime_error{"a result has no algorithm, input size or median time"};
+            }
+            baseline.push_back(std::move(result));
+        }
+    } catch (const std::logic_error&){
+        throw std::runtime_error{file_name + " holds an invalid number"};
+    } catch (const std::runtime_error& e){
+        throw std::runtime_error{file_name + ": " + e.what()};
+    }
+    return baseline;
+}
+
+struct regression {
+    baseline_result baseline;
+    algorithm_comparison_table::median_time_t median_time;
+    double slowdown;
+};
+
+/*
+ * a row is slower than its baseline when its median time exceeds the
+ * baseline median by more than threshold and the confidence intervals of
+ * the two medians do not overlap. rows without a baseline, or without a
+ * confidence interval, are not compared.
+ */
+[[nodiscard]] inline std::vector<regression>
+find_regressions(std::span<const algorithm_comparison_table::test_results_t> results,
+                 std::span<const baseline_result> baseline, double threshold)
+{
+    std::vector<regression> regressions;
+    for (const auto& results_row : results){
+        const auto& [
+            algorithm_name, distribution, input_size, test_count, comparison, assignment, allocation,
+            median_time, avg_time, speedup_value, memory_traffic, hardware_counters, statistics, cpu_share,
+            external_times
+        ] = results_row;
+        for (const auto& stored : baseline){
+            if (stored.algorithm != algorithm_name || stored.distribution != distribution ||
+                stored.input_size != input_size){
+                continue;
+            }
+            auto median{static_cast<double>(median_time.count())};
+            if (stored.median_ns <= 0 || !std::isfinite(stored.relative_error) ||
+                !std::isfinite(statistics.relative_error)){
+                break;
+            }
+            auto slowdown{median / stored.median_ns};
+            if (slowdown > 1. + threshold &&
+                median * (1. - statistics.relative_error) > stored.median_ns * (1. + stored.relative_error)){
+                regressions.push_back(regression{stored, median_time, slowdown});
+            }
+            break;
+        }
+    }
+    return regressions;
+}
+
+} /* namespace algorithms */
+
+#endif /* RESULT_EXPORT_HPP */
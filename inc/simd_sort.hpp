@@ -0,0 +1,429 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef SIMD_SORT_HPP
+#define SIMD_SORT_HPP
+
+#include <bit>
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <concepts>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ALGORITHMS_HAS_AVX2_KERNELS 1
+#define ALGORITHMS_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#else
+#define ALGORITHMS_HAS_AVX2_KERNELS 0
+#endif
+
+/*
+ * avx2 building blocks of the vectorized quick sort, a partition that packs
+ * the keys of every vector to both ends of the range with a permutation
+ * picked by the comparison mask, and a sort for blocks of lanes * lanes keys
+ * made of a vertical sorting network, a transpose and bitonic merges of the
+ * sorted registers. the kernels are compiled for avx2 through the target
+ * attribute, so the program still runs on cpus without it and callers must
+ * check avx2_supported() first. nan keys are not supported.
+ */
+namespace algorithms::simd {
+
+#if ALGORITHMS_HAS_AVX2_KERNELS
+
+template <typename T>
+struct avx2_traits;
+
+template <std::size_t Lanes>
+[[nodiscard]] consteval auto make_compress_table()
+{
+    constexpr std::size_t ratio{8 / Lanes};
+    std::array<std::array<std::int32_t, 8>, 1 << Lanes> table{};
+    for (std::size_t mask{}; mask < table.size(); ++mask){
+        std::size_t k{};
+        for (int greater{}; greater < 2; ++greater){
+            for (std::size_t lane{}; lane < Lanes; ++lane){
+                if (((mask >> lane) & 1) == static_cast<std::size_t>(greater)){
+                    for (std::size_t part{}; part < ratio; ++part){
+                        table[mask][k++] = static_cast<std::int32_t>(lane * ratio + part);
+                    }
+                }
+            }
+        }
+    }
+    return table;
+}
+
+/* lanes whose mask bit is set are moved behind the others, order is kept */
+template <std::size_t Lanes>
+[[nodiscard]] ALGORITHMS_AVX2 inline __m256i compress_permutation(int mask)
+{
+    alignas(32) static constexpr auto table{make_compress_table<Lanes>()};
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(table[mask].data()));
+}
+
+template <>
+struct avx2_traits<float> {
+    using value_type = float;
+    using vector_t = __m256;
+    static constexpr std::int64_t lanes = 8;
+    static constexpr value_type padding = std::numeric_limits<value_type>::infinity();
+
+    ALGORITHMS_AVX2 static vector_t load(const value_type* p) { return _mm256_loadu_ps(p); }
+    ALGORITHMS_AVX2 static void store(value_type* p, vector_t v) { _mm256_storeu_ps(p, v); }
+    ALGORITHMS_AVX2 static vector_t set1(value_type x) { return _mm256_set1_ps(x); }
+    ALGORITHMS_AVX2 static vector_t min(vector_t a, vector_t b) { return _mm256_min_ps(a, b); }
+    ALGORITHMS_AVX2 static vector_t max(vector_t a, vector_t b) { return _mm256_max_ps(a, b); }
+
+    ALGORITHMS_AVX2 static int greater_mask(vector_t v, vector_t pivot)
+    {
+        return _mm256_movemask_ps(_mm256_cmp_ps(v, pivot, _CMP_GT_OQ));
+    }
+
+    ALGORITHMS_AVX2 static int greater_equal_mask(vector_t v, vector_t pivot)
+    {
+        return _mm256_movemask_ps(_mm256_cmp_ps(v, pivot, _CMP_GE_OQ));
+    }
+
+    ALGORITHMS_AVX2 static vector_t compress(vector_t v, int mask)
+    {
+        return _mm256_permutevar8x32_ps(v, compress_permutation<lanes>(mask));
+    }
+
+    ALGORITHMS_AVX2 static vector_t reverse(vector_t v)
+    {
+        return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    ALGORITHMS_AVX2 static vector_t merge(vector_t v)
+    {
+        vector_t p{_mm256_permute2f128_ps(v, v, 0x01)};
+        v = _mm256_blend_ps(min(v, p), max(v, p), 0xF0);
+        p = _mm256_permute_ps(v, _MM_SHUFFLE(1, 0, 3, 2));
+        v = _mm256_blend_ps(min(v, p), max(v, p), 0xCC);
+        p = _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm256_blend_ps(min(v, p), max(v, p), 0xAA);
+    }
+
+    ALGORITHMS_AVX2 static void transpose(vector_t* r)
+    {
+        vector_t t[lanes], u[lanes];
+        for (std::int64_t i{}; i < lanes; i += 2){
+            t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+            t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+        }
+        for (std::int64_t i{}; i < lanes; i += 4){
+            u[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+            u[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+            u[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+            u[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        for (std::int64_t i{}; i < 4; ++i){
+            r[i] = _mm256_permute2f128_ps(u[i], u[i + 4], 0x20);
+            r[i + 4] = _mm256_permute2f128_ps(u[i], u[i + 4], 0x31);
+        }
+    }
+};
+
+template <>
+struct avx2_traits<std::int32_t> {
+    using value_type = std::int32_t;
+    using vector_t = __m256i;
+    static constexpr std::int64_t lanes = 8;
+    static constexpr value_type padding = std::numeric_limits<value_type>::max();
+
+    ALGORITHMS_AVX2 static vector_t load(const value_type* p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    ALGORITHMS_AVX2 static void store(value_type* p, vector_t v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+
+    ALGORITHMS_AVX2 static vector_t set1(value_type x) { return _mm256_set1_epi32(x); }
+    ALGORITHMS_AVX2 static vector_t min(vector_t a, vector_t b) { return _mm256_min_epi32(a, b); }
+    ALGORITHMS_AVX2 static vector_t max(vector_t a, vector_t b) { return _mm256_max_epi32(a, b); }
+
+    ALGORITHMS_AVX2 static int greater_mask(vector_t v, vector_t pivot)
+    {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, pivot)));
+    }
+
+    ALGORITHMS_AVX2 static int greater_equal_mask(vector_t v, vector_t pivot)
+    {
+        return ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, v))) & 0xFF;
+    }
+
+    ALGORITHMS_AVX2 static vector_t compress(vector_t v, int mask)
+    {
+        return _mm256_permutevar8x32_epi32(v, compress_permutation<lanes>(mask));
+    }
+
+    ALGORITHMS_AVX2 static vector_t reverse(vector_t v)
+    {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    ALGORITHMS_AVX2 static vector_t merge(vector_t v)
+    {
+        vector_t p{_mm256_permute2x128_si256(v, v, 0x01)};
+        v = _mm256_blend_epi32(min(v, p), max(v, p), 0xF0);
+        p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        v = _mm256_blend_epi32(min(v, p), max(v, p), 0xCC);
+        p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm256_blend_epi32(min(v, p), max(v, p), 0xAA);
+    }
+
+    ALGORITHMS_AVX2 static void transpose(vector_t* r)
+    {
+        __m256 f[lanes];
+        for (std::int64_t i{}; i < lanes; ++i){
+            f[i] = _mm256_castsi256_ps(r[i]);
+        }
+        avx2_traits<float>::transpose(f);
+        for (std::int64_t i{}; i < lanes; ++i){
+            r[i] = _mm256_castps_si256(f[i]);
+        }
+    }
+};
+
+template <>
+struct avx2_traits<double> {
+    using value_type = double;
+    using vector_t = __m256d;
+    static constexpr std::int64_t lanes = 4;
+    static constexpr value_type padding = std::numeric_limits<value_type>::infinity();
+
+    ALGORITHMS_AVX2 static vector_t load(const value_type* p) { return _mm256_loadu_pd(p); }
+    ALGORITHMS_AVX2 static void store(value_type* p, vector_t v) { _mm256_storeu_pd(p, v); }
+    ALGORITHMS_AVX2 static vector_t set1(value_type x) { return _mm256_set1_pd(x); }
+    ALGORITHMS_AVX2 static vector_t min(vector_t a, vector_t b) { return _mm256_min_pd(a, b); }
+    ALGORITHMS_AVX2 static vector_t max(vector_t a, vector_t b) { return _mm256_max_pd(a, b); }
+
+    ALGORITHMS_AVX2 static int greater_mask(vector_t v, vector_t pivot)
+    {
+        return _mm256_movemask_pd(_mm256_cmp_pd(v, pivot, _CMP_GT_OQ));
+    }
+
+    ALGORITHMS_AVX2 static int greater_equal_mask(vector_t v, vector_t pivot)
+    {
+        return _mm256_movemask_pd(_mm256_cmp_pd(v, pivot, _CMP_GE_OQ));
+    }
+
+    ALGORITHMS_AVX2 static vector_t compress(vector_t v, int mask)
+    {
+        return _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(
+            _mm256_castpd_si256(v), compress_permutation<lanes>(mask)
+        ));
+    }
+
+    ALGORITHMS_AVX2 static vector_t reverse(vector_t v)
+    {
+        return _mm256_permute4x64_pd(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+
+    ALGORITHMS_AVX2 static vector_t merge(vector_t v)
+    {
+        vector_t p{_mm256_permute2f128_pd(v, v, 0x01)};
+        v = _mm256_blend_pd(min(v, p), max(v, p), 0xC);
+        p = _mm256_permute_pd(v, 0x5);
+        return _mm256_blend_pd(min(v, p), max(v, p), 0xA);
+    }
+
+    ALGORITHMS_AVX2 static void transpose(vector_t* r)
+    {
+        vector_t t0{_mm256_unpacklo_pd(r[0], r[1])};
+        vector_t t1{_mm256_unpackhi_pd(r[0], r[1])};
+        vector_t t2{_mm256_unpacklo_pd(r[2], r[3])};
+        vector_t t3{_mm256_unpackhi_pd(r[2], r[3])};
+        r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+        r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+        r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+        r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+};
+
+template <typename T>
+concept avx2_sortable = requires { avx2_traits<T>::lanes; };
+
+[[nodiscard]] inline bool avx2_supported() noexcept
+{
+    static const bool supported{(__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0)};
+    return supported;
+}
+
+template <avx2_sortable T>
+inline constexpr std::int64_t avx2_block_size = avx2_traits<T>::lanes * avx2_traits<T>::lanes;
+
+/* vertical sorting networks, every column of the block gets sorted */
+template <std::int64_t Lanes>
+inline constexpr auto sorting_network{[](){
+    if constexpr (Lanes == 8){
+        return std::to_array<std::pair<int, int>>({
+            {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7},
+            {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5}, {1, 4}, {3, 6},
+            {1, 2}, {3, 4}, {5, 6}
+        });
+    } else {
+        return std::to_array<std::pair<int, int>>({
+            {0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2}
+        });
+    }
+}()};
+
+/* key comparisons done by avx2_sort_block, for the instrumented counts */
+template <avx2_sortable T>
+[[nodiscard]] consteval std::uint64_t avx2_block_comparisons()
+{
+    constexpr std::int64_t lanes{avx2_traits<T>::lanes};
+    std::uint64_t count{sorting_network<lanes>.size() * lanes};
+    for (std::int64_t width{1}; width < lanes; width *= 2){
+        count += lanes * lanes / 2 * static_cast<std::uint64_t>(
+            std::bit_width(static_cast<std::uint64_t>(width)) +
+            std::bit_width(static_cast<std::uint64_t>(lanes - 1))
+        );
+    }
+    return count;
+}
+
+template <avx2_sortable T>
+ALGORITHMS_AVX2 inline void avx2_sort_block(T* data, std::int64_t size)
+{
+    using traits = avx2_traits<T>;
+    using vector_t = typename traits::vector_t;
+    constexpr std::int64_t lanes{traits::lanes};
+    alignas(32) std::array<T, lanes * lanes> block;
+    std::copy(data, data + size, block.begin());
+    std::fill(block.begin() + size, block.end(), traits::padding);
+    vector_t r[lanes];
+    for (std::int64_t i{}; i < lanes; ++i){
+        r[i] = traits::load(block.data() + i * lanes);
+    }
+    for (auto [i, j] : sorting_network<lanes>){
+        vector_t low{traits::min(r[i], r[j])};
+        r[j] = traits::max(r[i], r[j]);
+        r[i] = low;
+    }
+    traits::transpose(r);
+    for (std::int64_t width{1}; width < lanes; width *= 2){
+        for (std::int64_t group{}; group < lanes; group += 2 * width){
+            auto* run{r + group};
+            for (std::int64_t i{}; i < width / 2; ++i){
+                std::swap(run[width + i], run[2 * width - 1 - i]);
+            }
+            for (std::int64_t i{}; i < width; ++i){
+                run[width + i] = traits::reverse(run[width + i]);
+            }
+            for (std::int64_t stride{width}; stride > 0; stride /= 2){
+                for (std::int64_t i{}; i < 2 * width; ++i){
+                    if ((i & stride) == 0){
+                        vector_t low{traits::min(run[i], run[i + stride])};
+                        run[i + stride] = traits::max(run[i], run[i + stride]);
+                        run[i] = low;
+                    }
+                }
+            }
+            for (std::int64_t i{}; i < 2 * width; ++i){
+                run[i] = traits::merge(run[i]);
+            }
+        }
+    }
+    for (std::int64_t i{}; i < lanes; ++i){
+        traits::store(block.data() + i * lanes, r[i]);
+    }
+    std::copy(block.begin(), block.begin() + size, data);
+}
+
+/* writes the keys of v that go left at store_left and the others before store_right */
+template <avx2_sortable T>
+ALGORITHMS_AVX2 inline void
+    avx2_partition_vector(T* data, typename avx2_traits<T>::vector_t v,
+                          typename avx2_traits<T>::vector_t pivot, bool equal_left,
+                          std::int64_t& store_left, std::int64_t& store_right)
+{
+    using traits = avx2_traits<T>;
+    int mask{equal_left ? traits::greater_mask(v, pivot) : traits::greater_equal_mask(v, pivot)};
+    int right_count{std::popcount(static_cast<unsigned>(mask))};
+    v = traits::compress(v, mask);
+    traits::store(data + store_left, v);
+    traits::store(data + store_right - traits::lanes, v);
+    store_left += traits::lanes - right_count;
+    store_right -= right_count;
+}
+
+/*
+ * partitions data[first..last) around pivot, keys equal to the pivot go to
+ * the left if equal_left is set, returns where the right part starts. the
+ * first and last vectors are kept in registers, so every vector that is read
+ * afterwards has room to be written to both ends without a bounds check.
+ */
+template <avx2_sortable T>
+[[nodiscard]] ALGORITHMS_AVX2 inline std::int64_t
+    avx2_partition(T* data, std::int64_t first, std::int64_t last, T pivot, bool equal_left)
+{
+    using traits = avx2_traits<T>;
+    using vector_t = typename traits::vector_t;
+    constexpr std::int64_t lanes{traits::lanes};
+    auto goes_left = [&](const T& value){
+        return equal_left ? !(pivot < value) : value < pivot;
+    };
+    if (last - first < 2 * lanes){
+        std::int64_t i{first};
+        for (std::int64_t j{first}; j < last; ++j){
+            if (goes_left(data[j])){
+                std::swap(data[i++], data[j]);
+            }
+        }
+        return i;
+    }
+    const vector_t pivot_vector{traits::set1(pivot)};
+    std::int64_t store_left{first}, store_right{last};
+    const vector_t first_vector{traits::load(data + first)};
+    const vector_t last_vector{traits::load(data + last - lanes)};
+    std::int64_t read_left{first + lanes}, read_right{last - lanes};
+    while (read_right - read_left >= lanes){
+        vector_t v;
+        if (read_left - store_left <= store_right - read_right){
+            v = traits::load(data + read_left);
+            read_left += lanes;
+        } else {
+            read_right -= lanes;
+            v = traits::load(data + read_right);
+        }
+        avx2_partition_vector<T>(data, v, pivot_vector, equal_left, store_left, store_right);
+    }
+    std::array<T, lanes> rest;
+    std::int64_t rest_size{read_right - read_left};
+    std::copy(data + read_left, data + read_right, rest.begin());
+    for (std::int64_t i{}; i < rest_size; ++i){
+        if (goes_left(rest[i])){
+            data[store_left++] = rest[i];
+        } else {
+            data[--store_right] = rest[i];
+        }
+    }
+    avx2_partition_vector<T>(data, first_vector, pivot_vector, equal_left,
+                             store_left, store_right);
+    avx2_partition_vector<T>(data, last_vector, pivot_vector, equal_left,
+                             store_left, store_right);
+    return store_left;
+}
+
+#else
+
+template <typename T>
+concept avx2_sortable = false;
+
+[[nodiscard]] inline bool avx2_supported() noexcept
+{
+    return false;
+}
+
+#endif
+
+} /* namespace algorithms::simd */
+
+#endif /* SIMD_SORT_HPP */
@@ -0,0 +1,211 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef SMALL_SORT_HPP
+#define SMALL_SORT_HPP
+
+#include <bit>
+#include <span>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <concepts>
+#include <functional>
+#include <algorithm>
+
+#include <operation_counter.hpp>
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+/* the largest number of inputs a sorting network is generated for */
+inline constexpr std::size_t max_network_size = 64;
+
+/*
+ * sorts for a few dozen inputs, the quadratic sorts on their own and the
+ * base cases of the divide and conquer sorts. the inner loops either do not
+ * branch on the inputs or need no bound check.
+ */
+namespace small_sort {
+
+/* orders a and b with conditional moves instead of a branch */
+template <algorithm_value_type ValueType, operation_counter Counter>
+inline void compare_exchange(ValueType& a, ValueType& b, Counter& comparison, Counter& assignment) noexcept
+{
+    ++comparison;
+    bool swap{b < a};
+    ValueType low{swap ? b : a};
+    b = swap ? a : b;
+    a = low;
+    assignment += 2;
+}
+
+/*
+ * calls visit with the comparators of batcher's odd-even merge sort network
+ * for the next power of two inputs, without the ones that reach past size.
+ * those would only compare with inputs larger than every other input, so
+ * the rest still sorts size inputs.
+ */
+template <typename Visit>
+constexpr void batcher_comparators(std::size_t size, Visit visit)
+{
+    const auto padded{std::bit_ceil(size)};
+    for (std::size_t p{1}; p < padded; p *= 2){
+        for (auto k{p}; k > 0; k /= 2){
+            for (auto j{k % p}; j + k < padded; j += 2 * k){
+                for (std::size_t i{}; i < std::min(k, padded - j - k); ++i){
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p) && i + j + k < size){
+                        visit(i + j, i + j + k);
+                    }
+                }
+            }
+        }
+    }
+}
+
+struct comparator {
+    std::uint8_t first;
+    std::uint8_t second;
+};
+
+template <std::size_t Size>
+inline constexpr std::size_t network_length{[]{
+    std::size_t length{};
+    batcher_comparators(Size, [&length](std::size_t, std::size_t){ ++length; });
+    return length;
+}()};
+
+/* the comparators of the network for Size inputs, generated at compile time */
+template <std::size_t Size>
+inline constexpr auto network{[]{
+    static_assert(Size <= max_network_size, "the network is too large");
+    std::array<comparator, network_length<Size>> comparators{};
+    std::size_t next{};
+    batcher_comparators(Size, [&comparators, &next](std::size_t first, std::size_t second){
+        comparators[next++] = comparator{static_cast<std::uint8_t>(first), static_cast<std::uint8_t>(second)};
+    });
+    return comparators;
+}()};
+
+template <std::size_t Size, algorithm_value_type ValueType, operation_counter Counter>
+void network_sort(ValueType* values, Counter& comparison, Counter& assignment) noexcept
+{
+    for (auto [first, second] : network<Size>){
+        compare_exchange(values[first], values[second], comparison, assignment);
+    }
+}
+
+/* sorts at most max_network_size values with the network for their size */
+template <algorithm_value_type ValueType, operation_counter Counter>
+void network_sort(std::span<ValueType> values, Counter& comparison, Counter& assignment) noexcept
+{
+    static constexpr auto sorts{[]<std::size_t... Sizes>(std::index_sequence<Sizes...>){
+        return std::array{&network_sort<Sizes, ValueType, Counter>...};
+    }(std::make_index_sequence<max_network_size + 1>{})};
+    sorts[values.size()](values.data(), comparison, assignment);
+}
+
+/* first[-1] is not larger than any of [first, last), so it stops every insertion */
+template <algorithm_value_type ValueType, operation_counter Counter>
+void unguarded_insertion_sort(ValueType* first, ValueType* last, Counter& comparison, Counter& assignment)
+{
+    for (auto next{first + 1}; next < last; ++next){
+        ValueType key{*next};
+        auto hole{next};
+        while (++comparison, key < *(hole - 1)){
+            *hole = *(hole - 1);
+            ++assignment;
+            --hole;
+        }
+        *hole = key;
+        ++assignment;
+    }
+}
+
+/*
+ * moves the first of the smallest values to the front, keeping the order
+ * of the others, and insertion sorts the rest with it as the sentinel.
+ */
+template <algorithm_value_type ValueType, operation_counter Counter>
+void sentinel_insertion_sort(std::span<ValueType> values, Counter& comparison, Counter& assignment)
+{
+    if (values.size() < 2){
+        return;
+    }
+    std::size_t min{};
+    for (std::size_t i{1}; i < values.size(); ++i){
+        ++comparison;
+        min = values[i] < values[min] ? i : min;
+    }
+    ValueType smallest{values[min]};
+    std::move_backward(values.begin(), values.begin() + min, values.begin() + min + 1);
+    values[0] = smallest;
+    assignment += min + 1;
+    unguarded_insertion_sort(values.data() + 1, values.data() + values.size(), comparison, assignment);
+}
+
+/* values[0, sorted) is sorted by less, every other value is binary searched for and moved to its place */
+template <std::movable ValueType, operation_counter Counter, typename Less = std::ranges::less>
+void binary_insertion_sort(std::span<ValueType> values, std::size_t sorted, Counter& comparison, Counter& assignment,
+                           Less less = {})
+{
+    for (auto i{std::max<std::size_t>(sorted, 1)}; i < values.size(); ++i){
+        ValueType pivot{std::move(values[i])};
+        std::size_t low{}, high{i};
+        while (low < high){
+            auto middle{low + (high - low) / 2};
+            ++comparison;
+            if (less(pivot, values[middle])){
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        std::move_backward(values.begin() + low, values.begin() + i, values.begin() + i + 1);
+        values[low] = std::move(pivot);
+        assignment += i - low + 2;
+    }
+}
+
+/* the minimum and its index are carried in registers, so the scan does not branch */
+template <algorithm_value_type ValueType, operation_counter Counter>
+void selection_sort(std::span<ValueType> values, Counter& comparison, Counter& assignment)
+{
+    for (std::size_t i{}; i + 1 < values.size(); ++i){
+        auto min{i};
+        ValueType smallest{values[i]};
+        for (auto j{i + 1}; j < values.size(); ++j){
+            ++comparison;
+            bool less{values[j] < smallest};
+            min = less ? j : min;
+            smallest = less ? values[j] : smallest;
+        }
+        assignment += 2;
+        std::swap(values[i], values[min]);
+    }
+}
+
+/* every pass ends at the last swap of the pass before it, so sorted inputs take one pass */
+template <algorithm_value_type ValueType, operation_counter Counter>
+void bubble_sort(std::span<ValueType> values, Counter& comparison, Counter& assignment)
+{
+    for (auto end{values.size()}; end > 1;){
+        std::size_t last_swap{};
+        for (std::size_t j{1}; j < end; ++j){
+            ++comparison;
+            if (values[j] < values[j - 1]){
+                assignment += 2;
+                std::swap(values[j - 1], values[j]);
+                last_swap = j;
+            }
+        }
+        end = last_swap;
+    }
+}
+
+} /* namespace small_sort */
+
+} /* namespace algorithms */
+
+#endif /* SMALL_SORT_HPP */
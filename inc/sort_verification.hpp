@@ -0,0 +1,145 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef SORT_VERIFICATION_HPP
+#define SORT_VERIFICATION_HPP
+
+#include <bit>
+#include <span>
+#include <cmath>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include <simd_sort.hpp>
+#include <random_stream.hpp>
+#include <algorithm_concepts.hpp>
+
+/*
+ * checks of the output of a sorting algorithm that run after its timed
+ * runs: whether the output is in order, whether it holds the same inputs
+ * and whether equal inputs kept their order.
+ */
+namespace algorithms {
+
+#if ALGORITHMS_HAS_AVX2_KERNELS
+
+namespace simd {
+
+/*
+ * compares every vector of inputs with the vector an input later, the
+ * descents of the inputs from last on are left to the caller.
+ */
+template <avx2_sortable T>
+[[nodiscard]] ALGORITHMS_AVX2 std::size_t count_descents(std::span<const T> values, std::size_t& last)
+{
+    using traits = avx2_traits<T>;
+    std::size_t descents{};
+    std::size_t i{};
+    for (; i + traits::lanes < values.size(); i += traits::lanes){
+        descents += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(
+            traits::greater_mask(traits::load(values.data() + i), traits::load(values.data() + i + 1))
+        )));
+    }
+    last = i;
+    return descents;
+}
+
+} /* namespace simd */
+
+#endif
+
+/* the number of inputs that are smaller than the input before them, zero when values are sorted */
+template <algorithm_value_type ValueType>
+[[nodiscard]] std::size_t count_descents(std::span<const ValueType> values)
+{
+    std::size_t descents{};
+    std::size_t first{};
+#if ALGORITHMS_HAS_AVX2_KERNELS
+    if constexpr (simd::avx2_sortable<ValueType>){
+        if (simd::avx2_supported()){
+            descents = simd::count_descents(values, first);
+        }
+    }
+#endif
+    for (auto i{first + 1}; i < values.size(); ++i){
+        descents += values[i] < values[i - 1];
+    }
+    return descents;
+}
+
+/*
+ * two sums of independent hashes of the inputs, they do not depend on the
+ * order of the inputs, so a sorted output has the hash of its inputs.
+ */
+struct multiset_hash {
+    std::uint64_t first;
+    std::uint64_t second;
+
+    /* the hash of both multisets together */
+    multiset_hash& operator+=(const multiset_hash& other) noexcept
+    {
+        first += other.first;
+        second += other.second;
+        return *this;
+    }
+
+    friend bool operator==(const multiset_hash&, const multiset_hash&) = default;
+};
+
+template <algorithm_value_type ValueType>
+[[nodiscard]] multiset_hash hash_multiset(std::span<const ValueType> values)
+{
+    multiset_hash hash{};
+    for (const auto& value : values){
+        auto key{static_cast<std::uint64_t>(std::hash<ValueType>{}(value))};
+        hash.first += random_stream{key, 1}(0);
+        hash.second += random_stream{key, 2}(0);
+    }
+    return hash;
+}
+
+/*
+ * the inputs of the stability check, integers from -stability_key_range to
+ * stability_key_range where the zeros are tagged with a random sign. -0.0
+ * and 0.0 are equal, so a stable sort keeps the signs of the zeros in the
+ * order of the inputs.
+ */
+inline constexpr std::int64_t stability_key_range = 3;
+
+[[nodiscard]] inline std::vector<double> make_stability_inputs(std::size_t size, std::uint64_t seed)
+{
+    random_stream stream{seed, 3};
+    std::vector<double> inputs(size);
+    for (std::size_t i{}; i < size; ++i){
+        auto key{stream.value<std::int64_t>(2 * i, -stability_key_range, stability_key_range)};
+        inputs[i] = static_cast<double>(key);
+        if (key == 0 && stream(2 * i + 1) & 1){
+            inputs[i] = -0.0;
+        }
+    }
+    return inputs;
+}
+
+/* whether the zeros of output have the signs of the zeros of inputs in the same order */
+[[nodiscard]] inline bool kept_order_of_zeros(std::span<const double> inputs, std::span<const double> output)
+{
+    std::vector<bool> signs;
+    for (auto value : inputs){
+        if (value == 0.){
+            signs.push_back(std::signbit(value));
+        }
+    }
+    std::size_t zero{};
+    for (auto value : output){
+        if (value == 0. && (zero == signs.size() || signs[zero++] != std::signbit(value))){
+            return false;
+        }
+    }
+    return zero == signs.size();
+}
+
+} /* namespace algorithms */
+
+#endif /* SORT_VERIFICATION_HPP */
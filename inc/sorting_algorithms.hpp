@@ -4,15 +4,48 @@
 #ifndef SORTING_ALGORITHMS_HPP
 #define SORTING_ALGORITHMS_HPP
 
+#include <bit>
+#include <span>
+#include <tuple>
+#include <array>
 #include <bitset>
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <chrono>
 #include <random>
 #include <limits>
+#include <memory>
+#include <thread>
+#include <optional>
 #include <fstream>
+#include <numeric>
+#include <utility>
+#include <cstring>
+#include <exception>
+#include <algorithm>
 #include <functional>
 
+#include <simd_sort.hpp>
+#include <input_file.hpp>
+#include <external_sort.hpp>
+#include <streaming_sorter.hpp>
+#include <record_sort.hpp>
+#include <tim_sort.hpp>
+#include <d_ary_heap_sort.hpp>
+#include <small_sort.hpp>
+#include <sort_verification.hpp>
+#include <range_algorithms.hpp>
+#include <random_stream.hpp>
+#include <input_distribution.hpp>
+#include <task_pool.hpp>
+#include <operation_counter.hpp>
+#include <counting_allocator.hpp>
 #include <algorithm_concepts.hpp>
+#include <cache_info.hpp>
+#include <cpu_affinity.hpp>
+#include <result_export.hpp>
+#include <input_size_sweep.hpp>
 #include <algorithm_comparison_table.hpp>
 
 namespace algorithms {
@@ -20,9 +53,11 @@ namespace algorithms {
 template <algorithm_value_type ValueType = int>
 class sorting_algorithms {
 public:
-    static constexpr std::size_t sorting_algorithm_count = 6;
+    static constexpr std::size_t sorting_algorithm_count = 29;
     static constexpr std::int64_t default_output_file_count = 5;
     static constexpr std::int64_t default_test_count = 21;
+    static constexpr std::int64_t default_warmup_count = 1;
+    static constexpr std::int64_t default_concurrent_jobs = 1;
     static constexpr std::int64_t default_input_size = 5'000;
 
     enum algorithms {
@@ -33,6 +68,30 @@ public:
         insertion = 1L << 4,
         heap      = 1L << 5,
 
+        parallel_merge = 1L << 6,
+        sample         = 1L << 7,
+        buffered_merge = 1L << 8,
+        intro          = 1L << 9,
+        pdq            = 1L << 10,
+        lsd_radix      = 1L << 11,
+        msd_radix      = 1L << 12,
+        simd           = 1L << 13,
+        lsm_stream     = 1L << 14,
+        lsm_top_k      = 1L << 15,
+        nth_element    = 1L << 16,
+        partial_sort   = 1L << 17,
+        heap_top_k     = 1L << 18,
+        quick_top_k    = 1L << 19,
+        tim            = 1L << 20,
+        floyd_heap     = 1L << 21,
+        four_ary_heap  = 1L << 22,
+        eight_ary_heap = 1L << 23,
+        four_ary_pf    = 1L << 24,
+        eight_ary_pf   = 1L << 25,
+        sentinel_ins   = 1L << 26,
+        binary_ins     = 1L << 27,
+        intro_net      = 1L << 28,
+
         all       = (1L << sorting_algorithm_count) - 1
     };
 
@@ -50,33 +109,20 @@ public:
     }
 
     sorting_algorithms(std::int64_t input_size,
-                       std::int64_t test_count = default_test_count)
+                       std::int64_t test_count = default_test_count,
+                       input_distribution distribution = input_distribution::uniform)
         : m_test_count{test_count},
-        m_input_size{input_size}
+        m_input_size{input_size},
+        m_distribution{distribution}
     {
         check_argumants(m_test_count, m_input_size);
-        m_vec.reserve(m_input_size);
-        generate_n(back_inserter(m_vec), m_input_size,
-            [](){ return sorting_algorithms::generate_random_numbers(); }
-        );
+        generate_inputs();
     }
 
     sorting_algorithms(const std::string& file_name,
                        std::int64_t test_count = default_test_count)
-        : m_test_count{test_count}
     {
-        m_vec.reserve(default_input_size);
-        std::ifstream file{file_name};
-        if (!file){
-            throw std::runtime_error{"failed to open " + file_name};
-        }
-        ValueType input{};
-        while(file >> input){
-            m_vec.push_back(input);
-        }
-        m_vec.shrink_to_fit();
-        m_input_size = std::ssize(m_vec);
-        check_argumants(m_test_count, m_input_size);
+        set(file_name, test_count);
     }
 
     [[nodiscard]]
@@ -91,6 +137,106 @@ public:
         return m_input_size;
     }
 
+    /*
+     * counts the hardware events of the timed runs on the calling thread with
+     * perf_event_open and shows them in the table, events that cannot be
+     * counted are shown as "-".
+     */
+    void set_hardware_counters(bool enable) noexcept
+    {
+        m_hardware_counters = enable;
+        m_comparison_table.show_hardware_counters(enable);
+    }
+
+    /* shows the spread and the confidence of the measured times in the table */
+    void set_statistics(bool enable) noexcept
+    {
+        m_comparison_table.show_statistics(enable);
+    }
+
+    /* checks the output of every algorithm after its timed runs, on by default */
+    void set_verification(bool enable) noexcept
+    {
+        m_verification = enable;
+    }
+
+    [[nodiscard]]
+    std::int64_t get_warmup_count() const noexcept
+    {
+        return m_warmup_count;
+    }
+
+    /* untimed runs of each algorithm before its timed runs, to fill the caches and the branch predictor */
+    void set_warmup_count(std::int64_t warmup_count)
+    {
+        if (warmup_count < 0){
+            throw std::runtime_error{"warm-up count cannot be negative"};
+        }
+        m_warmup_count = warmup_count;
+    }
+
+    [[nodiscard]]
+    double get_target_error() const noexcept
+    {
+        return m_target_error;
+    }
+
+    /*
+     * stops the timed runs of an algorithm once the half width of the
+     * confidence interval of its median time, relative to the median, is
+     * below target_error. the test count is then the maximum number of runs,
+     * zero runs every algorithm test count times.
+     */
+    void set_target_error(double target_error)
+    {
+        if (!(target_error >= 0.)){
+            throw std::runtime_error{"target error cannot be negative"};
+        }
+        m_target_error = target_error;
+    }
+
+    [[nodiscard]]
+    std::int64_t get_concurrent_jobs() const noexcept
+    {
+        return m_concurrent_jobs;
+    }
+
+    /*
+     * runs up to jobs tests of serial algorithms at the same time, each on its
+     * own thread pinned to one of the cpus the process may run on and with its
+     * own copy of the inputs. the parallel algorithms use the task pool and are
+     * always tested alone. one runs every test after the other.
+     */
+    void set_concurrent_jobs(std::int64_t jobs)
+    {
+        if (jobs <= 0){
+            throw std::runtime_error{"job count cannot be zero or negative"};
+        }
+        m_concurrent_jobs = jobs;
+        m_comparison_table.show_cpu_share(jobs > 1);
+    }
+
+    /* the distribution of generated inputs, empty for inputs read from a file or a container */
+    [[nodiscard]]
+    std::optional<input_distribution> get_distribution() const noexcept
+    {
+        return m_distribution;
+    }
+
+    /* time spent reading the inputs of the last file, zero for generated inputs */
+    [[nodiscard]]
+    algorithm_comparison_table::us_t get_load_time() const noexcept
+    {
+        return m_load_time;
+    }
+
+    /* the rows of every table built by compare, in the order they are shown */
+    [[nodiscard]]
+    const std::vector<algorithm_comparison_table::test_results_t>& get_results() const noexcept
+    {
+        return m_results;
+    }
+
     [[nodiscard]]
     const std::vector<ValueType>& get_inputs() const & noexcept
     {
@@ -123,6 +269,26 @@ public:
         check_argumants(m_test_count, m_input_size);
     }
 
+    [[nodiscard]]
+    static std::int64_t get_thread_count() noexcept
+    {
+        if (m_thread_count == 0){
+            return std::max<std::int64_t>(std::thread::hardware_concurrency(), 1);
+        }
+        return m_thread_count;
+    }
+
+    static void set_thread_count(std::int64_t thread_count)
+    {
+        if (thread_count <= 0){
+            throw std::runtime_error{"thread count cannot be zero or negative"};
+        }
+        if (thread_count != get_thread_count()){
+            m_task_pool.reset();
+        }
+        m_thread_count = thread_count;
+    }
+
     template <algorithm_container Container>
     requires std::same_as<typename Container::value_type, ValueType>
         void set(const Container& c, std::int64_t test_count = default_test_count)
@@ -130,75 +296,99 @@ public:
         m_test_count = test_count;
         m_vec = std::move(std::vector<ValueType>{begin(c), end(c)});
         m_input_size = std::ssize(m_vec);
+        m_load_time = {};
+        m_distribution.reset();
         check_argumants(m_test_count, m_input_size);
     }
 
     void set(std::int64_t input_size,
-             std::int64_t test_count = default_test_count)
+             std::int64_t test_count = default_test_count,
+             input_distribution distribution = input_distribution::uniform)
     {
         check_argumants(test_count, input_size);
-        m_vec.clear();
-        m_vec.reserve(input_size);
         m_input_size = input_size;
         m_test_count = test_count;
-        generate_n(back_inserter(m_vec), m_input_size,
-            [](){ return sorting_algorithms::generate_random_numbers(); }
-        );
+        m_load_time = {};
+        m_distribution = distribution;
+        generate_inputs();
     }
 
     void set(const std::string& file_name,
              std::int64_t test_count = default_test_count)
     {
-        m_vec.clear();
-        m_vec.reserve(default_input_size);
+        auto start = std::chrono::steady_clock::now();
+        m_vec = read_input_file<ValueType>(file_name, &get_task_pool());
+        auto end = std::chrono::steady_clock::now();
+        m_load_time = std::chrono::duration_cast<table::us_t>(end - start);
         m_test_count = test_count;
-        std::ifstream file{file_name};
-        if (!file){
-            throw std::runtime_error{"failed to open " + file_name};
-        }
-        ValueType input{};
-        while(file >> input){
-            m_vec.push_back(input);
-        }
-        m_vec.shrink_to_fit();
         m_input_size = std::ssize(m_vec);
+        m_distribution.reset();
         check_argumants(m_test_count, m_input_size);
     }
 
+    [[nodiscard]]
+    static std::uint64_t get_seed() noexcept
+    {
+        return m_seed;
+    }
+
+    static void set_seed(std::uint64_t seed) noexcept
+    {
+        m_seed = seed;
+    }
+
+    /*
+     * the i-th file holds stream i of the seed, the files are written in
+     * parallel. uniform inputs are generated and written in chunks, the other
+     * distributions are shaped as a whole before writing.
+     */
     static void
     generate_input_files(std::int64_t input_size = default_input_size,
                          std::int64_t output_file_count = default_output_file_count,
+                         input_file_format format = input_file_format::text,
+                         input_distribution distribution = input_distribution::uniform,
                          ValueType min = std::numeric_limits<ValueType>::min(),
                          ValueType max = std::numeric_limits<ValueType>::max())
     {
+        task_pool::task_group group{get_task_pool()};
         for (std::int64_t i{1}; i <= output_file_count; ++i){
-            std::ofstream file{"input" + std::to_string(i) + ".txt"};
-            if (!file){
-                throw std::runtime_error{
-                    "failed to create input" + std::to_string(i) + ".txt"
+            group.run([=](){
+                input_file_writer<ValueType> file{
+                    "input" + std::to_string(i) + input_file_writer<ValueType>::extension(format),
+                    format, static_cast<std::uint64_t>(input_size)
                 };
-            }
-            for (std::int64_t j{}; j < input_size; ++j){
-                file << sorting_algorithms::generate_random_numbers(min, max) << "\n";
-            }
+                if (distribution != input_distribution::uniform){
+                    std::vector<ValueType> values(input_size);
+                    generate_input_distribution<ValueType>(
+                        values, distribution, random_stream{get_seed(), static_cast<std::uint64_t>(i)}, min, max
+                    );
+                    file.write(values);
+                    return;
+                }
+                std::vector<ValueType> chunk(std::min(input_size, generate_chunk_size));
+                for (std::int64_t j{}; j < input_size; j += generate_chunk_size){
+                    std::span<ValueType> values{
+                        chunk.data(), static_cast<std::size_t>(std::min(generate_chunk_size, input_size - j))
+                    };
+                    generate_random_numbers(values, i, j, min, max);
+                    file.write(values);
+                }
+            });
         }
+        group.wait();
     }
 
-    [[nodiscard]] static ValueType
-    generate_random_numbers(ValueType min = std::numeric_limits<ValueType>::min(),
+    /* fills values with the numbers first, first + 1, ... of the given stream of the seed */
+    static void
+    generate_random_numbers(std::span<ValueType> values,
+                            std::uint64_t stream_id,
+                            std::uint64_t first = 0,
+                            ValueType min = std::numeric_limits<ValueType>::min(),
                             ValueType max = std::numeric_limits<ValueType>::max())
     {
-        static std::mt19937_64 eng{
-            static_cast<unsigned long>(
-                std::chrono::system_clock::now().time_since_epoch().count()
-            )
-        };
-        if constexpr (std::integral<ValueType>){
-            static std::uniform_int_distribution<ValueType> distribution{min, max};
-            return distribution(eng);
-        } else if constexpr (std::floating_point<ValueType>){
-            static std::uniform_real_distribution<ValueType> distribution{min, max};
-            return distribution(eng);
+        random_stream stream{get_seed(), stream_id};
+        for (std::size_t i{}; i < values.size(); ++i){
+            values[i] = stream.value(first + i, min, max);
         }
     }
 
@@ -206,44 +396,704 @@ public:
         compare(const std::bitset<sorting_algorithm_count>& algorithm_select
                 = algorithms::all)
     {
+        auto first_row{m_results.size()};
+        m_contention = {};
+        m_comparison_table.add_title();
+        add_results(algorithm_select, std::span{&m_input_size, 1});
+        m_comparison_table.add_table_separator_line();
+        return m_comparison_table.get_table() + describe_natural_runs(first_row) + describe_contention(first_row);
+    }
+
+    /* regenerates the inputs with each distribution and compares the algorithms on all of them */
+    [[nodiscard]] std::string
+        compare(const std::bitset<sorting_algorithm_count>& algorithm_select,
+                const std::vector<input_distribution>& distributions)
+    {
+        auto first_row{m_results.size()};
+        m_contention = {};
+        m_comparison_table.add_title();
+        for (auto distribution : distributions){
+            if (m_distribution != distribution){
+                set(m_input_size, m_test_count, distribution);
+            }
+            add_results(algorithm_select, std::span{&m_input_size, 1});
+        }
+        m_comparison_table.add_table_separator_line();
+        return m_comparison_table.get_table() + describe_natural_runs(first_row) + describe_contention(first_row);
+    }
+
+    /*
+     * compares the algorithms on every input size of each distribution and
+     * fits the median times of every algorithm to n, n log n and n^2. uniform
+     * inputs are generated once for the largest size and every size sorts a
+     * prefix of them, which holds the same numbers as generating that size.
+     * the other distributions depend on the size and are generated for each.
+     */
+    [[nodiscard]] std::string
+        sweep(const std::bitset<sorting_algorithm_count>& algorithm_select,
+              std::span<const std::int64_t> input_sizes,
+              const std::vector<input_distribution>& distributions)
+    {
+        if (input_sizes.empty()){
+            throw std::runtime_error{"no input size is selected"};
+        }
+        auto max_input_size{*std::max_element(input_sizes.begin(), input_sizes.end())};
+        for (auto input_size : input_sizes){
+            check_argumants(m_test_count, input_size);
+        }
+        auto first_row{m_results.size()};
+        m_contention = {};
+        m_comparison_table.show_scaling(sizeof(ValueType));
+        m_comparison_table.add_title();
+        for (auto distribution : distributions){
+            if (distribution == input_distribution::uniform){
+                set(max_input_size, m_test_count, distribution);
+                add_results(algorithm_select, input_sizes);
+                continue;
+            }
+            for (const auto& input_size : input_sizes){
+                set(input_size, m_test_count, distribution);
+                add_results(algorithm_select, std::span{&input_size, 1});
+            }
+        }
+        m_comparison_table.add_table_separator_line();
+        m_comparison_table.show_scaling(0);
+        return m_comparison_table.get_table() + describe_scaling(first_row) + describe_natural_runs(first_row) +
+               describe_contention(first_row);
+    }
+
+    /*
+     * sorts records made of each input as the key and a payload of each of
+     * the given sizes, which holds the position of the key in the inputs,
+     * with every record layout. the speedups are over sorting the structs
+     * and the memory traffic is the bytes of pairs and records moved. an
+     * empty list of distributions sorts the current inputs.
+     */
+    [[nodiscard]] std::string
+        compare_records(std::span<const std::size_t> payload_sizes,
+                        const std::vector<input_distribution>& distributions = {})
+    {
+        auto first_row{m_results.size()};
+        m_contention = {};
         m_comparison_table.add_title();
-        for (std::size_t i{}; i < sorting_algorithm_count; ++i){
-            if (algorithm_select[i]){
-                m_comparison_table.add_row(perform_test(m_algorithms[i]));
+        auto add = [&](){
+            for (auto payload_size : payload_sizes){
+                add_record_results(payload_size, std::make_index_sequence<record_payload_sizes.size()>{});
             }
+        };
+        if (distributions.empty()){
+            add();
+        }
+        for (auto distribution : distributions){
+            if (m_distribution != distribution){
+                set(m_input_size, m_test_count, distribution);
+            }
+            add();
+        }
+        m_comparison_table.add_table_separator_line();
+        return m_comparison_table.get_table() + describe_contention(first_row);
+    }
+
+    /*
+     * sorts input_file into output_file holding at most about memory_limit
+     * bytes of inputs in memory, the runs are sorted with sample sort on the
+     * task pool. the row shows the wall time as the median and average time,
+     * the passes over the inputs and the bytes read and written as the memory
+     * traffic, and the i/o and cpu times in columns of their own.
+     */
+    [[nodiscard]] std::string
+        external_sort(const std::string& input_file, const std::string& output_file,
+                      std::uint64_t memory_limit, input_file_format format,
+                      const std::filesystem::path& temp_directory = std::filesystem::temp_directory_path())
+    {
+        external_sorter<ValueType> sorter{memory_limit, temp_directory, [](std::vector<ValueType>& run){
+            null_counter comparison, assignment;
+            sample_sort<null_counter>(run, std::ssize(run), comparison, assignment);
+        }};
+        auto allocation{counting_allocator<ValueType>::get_allocation_count()};
+        auto stats{sorter.sort(input_file, output_file, format)};
+        allocation = counting_allocator<ValueType>::get_allocation_count() - allocation;
+        if (m_verification){
+            verify_external(input_file, output_file);
         }
+        std::vector<std::int64_t> times{stats.wall_time.count()};
+        auto statistics{summarize(times)};
+        /* the runs are made in one pass over the inputs and every merge is another */
+        table::test_results_t results{
+            "external", "-", static_cast<table::input_size_t>(stats.count), 1, 0, 0, allocation,
+            stats.wall_time, stats.wall_time, table::speedup_t{},
+            table::memory_traffic{
+                static_cast<double>(1 + stats.merge_passes), stats.bytes_read + stats.bytes_written
+            },
+            table::hardware_counters_t{}, statistics, table::cpu_share_t{},
+            table::external_times{stats.io_time, stats.cpu_time}
+        };
+        m_comparison_table.show_external_times(true);
+        m_comparison_table.add_title();
+        m_comparison_table.add_row(results);
         m_comparison_table.add_table_separator_line();
-        return m_comparison_table.get_table();
+        m_comparison_table.show_external_times(false);
+        m_results.push_back(std::move(results));
+        return m_comparison_table.get_table() + std::format(
+            "{} run{} of at most {} inputs merged in {} pass{}\n",
+            stats.runs, stats.runs == 1 ? "" : "s", table::readable(sorter.get_run_size()),
+            stats.merge_passes, stats.merge_passes == 1 ? "" : "es"
+        );
+    }
+
+    /* parses a comma separated list of algorithm names as shown in the table, "all" selects every algorithm */
+    [[nodiscard]] std::bitset<sorting_algorithm_count> parse_algorithms(std::string_view names) const
+    {
+        std::bitset<sorting_algorithm_count> algorithm_select;
+        while (!names.empty()){
+            auto separator{names.find(',')};
+            auto name{names.substr(0, separator)};
+            names = separator == std::string_view::npos ? std::string_view{} : names.substr(separator + 1);
+            if (name == "all"){
+                algorithm_select.set();
+                continue;
+            }
+            auto entry{std::find_if(m_algorithms.begin(), m_algorithms.end(),
+                [name](const auto& entry){ return std::get<table::algorithm_name_t>(entry) == name; }
+            )};
+            if (entry == m_algorithms.end()){
+                throw std::runtime_error{"unknown algorithm " + std::string{name}};
+            }
+            algorithm_select.set(static_cast<std::size_t>(entry - m_algorithms.begin()));
+        }
+        if (algorithm_select.none()){
+            throw std::runtime_error{"no algorithm is selected"};
+        }
+        return algorithm_select;
     }
 
 private:
     std::vector<ValueType> m_vec;
     std::int64_t m_test_count{};
     std::int64_t m_input_size{};
+    algorithm_comparison_table::us_t m_load_time{};
+    std::optional<input_distribution> m_distribution{};
+    bool m_hardware_counters{};
+    bool m_verification{true};
+    std::int64_t m_warmup_count{default_warmup_count};
+    double m_target_error{};
+    std::int64_t m_concurrent_jobs{default_concurrent_jobs};
     algorithm_comparison_table m_comparison_table{};
+    std::vector<algorithm_comparison_table::test_results_t> m_results;
+
+    inline static std::int64_t m_thread_count{};
+    inline static std::unique_ptr<task_pool> m_task_pool{};
+    /* the natural runs the last tim sort on this thread found, tests run on one thread */
+    inline static thread_local std::size_t m_tim_natural_runs{};
+    inline static std::uint64_t m_seed{random_seed()};
+
+    static constexpr std::int64_t generate_chunk_size = 1L << 16;
+    /* the error of the median is first estimated after this many runs */
+    static constexpr std::int64_t min_target_error_test_count = 5;
+    /* concurrent tests below this cpu share waited for a cpu and are reported as distorted */
+    static constexpr double min_undistorted_cpu_share = 0.95;
+    static constexpr std::int64_t parallel_sort_cutoff = 1L << 13;
+    static constexpr std::int64_t parallel_merge_cutoff = 1L << 14;
+    static constexpr std::int64_t sample_sort_buckets_per_thread = 4;
+    static constexpr std::int64_t sample_sort_oversampling = 16;
+    static constexpr std::int64_t insertion_sort_cutoff = 16;
+    static constexpr std::int64_t network_sort_cutoff = 32;
+    static constexpr std::int64_t ninther_threshold = 128;
+    static constexpr std::int64_t pdq_insertion_sort_cutoff = 24;
+    static constexpr std::int64_t pdq_partial_insertion_sort_limit = 8;
+    static constexpr std::int64_t pdq_block_size = 64;
+    static constexpr std::int64_t radix_bits = 8;
+    static constexpr std::int64_t stream_chunk_size = 1L << 10;
+    static constexpr std::size_t stream_top_k = 16;
+    /* the top-k and partial sort entries select this percent of the inputs */
+    static constexpr std::int64_t selection_percent = 1;
+    static constexpr std::int64_t radix_size = 1L << radix_bits;
+    static constexpr std::int64_t msd_radix_insertion_sort_cutoff = 32;
 
     using table = algorithm_comparison_table;
 
+    template <typename T>
+    using scratch_vector = std::vector<T, counting_allocator<T>>;
+
+    /* timed runs use the null_counter instantiation, a separate run collects the counts */
+    template <operation_counter Counter>
     using algorithm_signature_t = void(*)(
         std::vector<ValueType>&,
         const table::input_size_t&,
-        table::comparison_count_t&,
-        table::assignment_count_t&
+        Counter&,
+        Counter&
     );
 
-    using algorithm_pair_t = std::pair<
+    using timed_algorithm_t = algorithm_signature_t<null_counter>;
+    using counted_algorithm_t = algorithm_signature_t<table::comparison_count_t>;
+
+    /*
+     * radix sorts count the keys they read in place of comparisons, the table
+     * turns those into passes over the input and bytes of memory traffic.
+     */
+    enum class count_kind {
+        comparisons, key_reads
+    };
+
+    /* floating point keys are radix sorted through their ieee 754 bit pattern */
+    static constexpr bool radix_sortable = std::integral<ValueType> ||
+        (std::numeric_limits<ValueType>::is_iec559 &&
+         (sizeof(ValueType) == sizeof(std::uint32_t) || sizeof(ValueType) == sizeof(std::uint64_t)));
+
+    using radix_key_t = typename std::conditional_t<
+        std::integral<ValueType>,
+        std::make_unsigned<ValueType>,
+        std::conditional<sizeof(ValueType) == sizeof(std::uint32_t), std::uint32_t, std::uint64_t>
+    >::type;
+
+    static constexpr count_kind radix_count_kind =
+        radix_sortable ? count_kind::key_reads : count_kind::comparisons;
+
+    /* parallel algorithms run on the task pool and are not tested concurrently with others */
+    enum class execution {
+        serial, parallel
+    };
+
+    /*
+     * what the output of an algorithm is checked for, stable sorts keep equal
+     * inputs in their order and partial ones only move the selected smallest
+     * inputs to the front.
+     */
+    enum class ordering {
+        stable, unstable, partial
+    };
+
+    /* the stability of an algorithm is checked on at most this many inputs */
+    static constexpr std::int64_t max_stability_check_size = 1L << 16;
+    /* the inputs and the output of an external sort are verified in blocks of this many values */
+    static constexpr std::size_t external_verification_block_size = 1UL << 16;
+
+    /* the scratch memory of perform_test, every concurrent job owns one */
+    struct test_state {
+        /* the private copy of the inputs of a concurrent job */
+        std::vector<ValueType> inputs;
+        /* every run sorts a copy of the inputs in this buffer, so the runs do not allocate */
+        std::vector<ValueType> buffer;
+        std::vector<std::int64_t> times;
+    };
+
+    struct test_job {
+        std::size_t algorithm;
+        std::int64_t input_size;
+        std::optional<table::test_results_t> results;
+        /* the natural runs tim sort found in the counted run */
+        std::size_t natural_runs;
+    };
+
+    /* how the tests of the last comparison ran concurrently */
+    struct contention {
+        std::size_t job_count;
+        std::size_t thread_count;
+        std::vector<int> cpus;
+        bool pinned;
+        /* the inputs and buffers of the largest jobs that could run at the same time */
+        std::uint64_t working_set;
+    };
+
+    test_state m_state;
+    contention m_contention{};
+    /* the row of every tim sort test and the number of natural runs in its inputs */
+    std::vector<std::pair<std::size_t, std::size_t>> m_natural_runs;
+
+    /* the algorithms element is the serial algorithm that speedup is reported against */
+    using algorithm_entry_t = std::tuple<
         table::algorithm_name_t,
-        algorithm_signature_t
+        timed_algorithm_t,
+        counted_algorithm_t,
+        algorithms,
+        count_kind,
+        execution,
+        ordering
     >;
 
-    std::array<algorithm_pair_t, sorting_algorithm_count> m_algorithms{
-        std::make_pair("selection", sorting_algorithms::selection_sort),
-        std::make_pair("buble", sorting_algorithms::bubble_sort),
-        std::make_pair("quick", sorting_algorithms::quick_sort),
-        std::make_pair("merge", sorting_algorithms::merge_sort),
-        std::make_pair("insertion", sorting_algorithms::insertion_sort),
-        std::make_pair("heap", sorting_algorithms::heap_sort)
-    };
+    /* the stability check sorts floating point inputs with the entries of sorting_algorithms<double> */
+    template <algorithm_value_type>
+    friend class sorting_algorithms;
+
+    /* the entries do not depend on the inputs, so every type of inputs keeps one table */
+    [[nodiscard]]
+    static const std::array<algorithm_entry_t, sorting_algorithm_count>& algorithm_entries()
+    {
+        static const std::array<algorithm_entry_t, sorting_algorithm_count> entries{
+            std::make_tuple("selection",
+                sorting_algorithms::selection_sort<null_counter>, sorting_algorithms::selection_sort<std::uint64_t>,
+                selection, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("buble",
+                sorting_algorithms::bubble_sort<null_counter>, sorting_algorithms::bubble_sort<std::uint64_t>,
+                bubble, count_kind::comparisons, execution::serial, ordering::stable),
+            std::make_tuple("quick",
+                sorting_algorithms::quick_sort<null_counter>, sorting_algorithms::quick_sort<std::uint64_t>,
+                quick, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("merge",
+                sorting_algorithms::merge_sort<null_counter>, sorting_algorithms::merge_sort<std::uint64_t>,
+                merge, count_kind::comparisons, execution::serial, ordering::stable),
+            std::make_tuple("insertion",
+                sorting_algorithms::insertion_sort<null_counter>, sorting_algorithms::insertion_sort<std::uint64_t>,
+                insertion, count_kind::comparisons, execution::serial, ordering::stable),
+            std::make_tuple("heap",
+                sorting_algorithms::heap_sort<null_counter>, sorting_algorithms::heap_sort<std::uint64_t>,
+                heap, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("par merge",
+                sorting_algorithms::parallel_merge_sort<null_counter>, sorting_algorithms::parallel_merge_sort<std::uint64_t>,
+                merge, count_kind::comparisons, execution::parallel, ordering::stable),
+            std::make_tuple("sample",
+                sorting_algorithms::sample_sort<null_counter>, sorting_algorithms::sample_sort<std::uint64_t>,
+                intro, count_kind::comparisons, execution::parallel, ordering::unstable),
+            std::make_tuple("buf merge",
+                sorting_algorithms::buffered_merge_sort<null_counter>, sorting_algorithms::buffered_merge_sort<std::uint64_t>,
+                merge, count_kind::comparisons, execution::serial, ordering::stable),
+            std::make_tuple("intro",
+                sorting_algorithms::intro_sort<null_counter>, sorting_algorithms::intro_sort<std::uint64_t>,
+                quick, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("pdq",
+                sorting_algorithms::pdq_sort<null_counter>, sorting_algorithms::pdq_sort<std::uint64_t>,
+                quick, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("lsd radix",
+                sorting_algorithms::lsd_radix_sort<null_counter>, sorting_algorithms::lsd_radix_sort<std::uint64_t>,
+                lsd_radix, radix_count_kind, execution::serial, ordering::stable),
+            std::make_tuple("msd radix",
+                sorting_algorithms::msd_radix_sort<null_counter>, sorting_algorithms::msd_radix_sort<std::uint64_t>,
+                msd_radix, radix_count_kind, execution::serial, ordering::unstable),
+            std::make_tuple("simd",
+                sorting_algorithms::simd_sort<null_counter>, sorting_algorithms::simd_sort<std::uint64_t>,
+                quick, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("lsm stream",
+                sorting_algorithms::lsm_stream_sort<null_counter>, sorting_algorithms::lsm_stream_sort<std::uint64_t>,
+                pdq, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("lsm top-k",
+                sorting_algorithms::lsm_top_k_sort<null_counter>, sorting_algorithms::lsm_top_k_sort<std::uint64_t>,
+                lsm_stream, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("nth element",
+                sorting_algorithms::nth_element_select<null_counter>, sorting_algorithms::nth_element_select<std::uint64_t>,
+                intro, count_kind::comparisons, execution::serial, ordering::partial),
+            std::make_tuple("partial 1%",
+                sorting_algorithms::partial_sort_select<null_counter>, sorting_algorithms::partial_sort_select<std::uint64_t>,
+                intro, count_kind::comparisons, execution::serial, ordering::partial),
+            std::make_tuple("heap top-k",
+                sorting_algorithms::heap_top_k_select<null_counter>, sorting_algorithms::heap_top_k_select<std::uint64_t>,
+                intro, count_kind::comparisons, execution::serial, ordering::partial),
+            std::make_tuple("quick top-k",
+                sorting_algorithms::quick_top_k_select<null_counter>, sorting_algorithms::quick_top_k_select<std::uint64_t>,
+                intro, count_kind::comparisons, execution::serial, ordering::partial),
+            std::make_tuple("tim",
+                sorting_algorithms::tim_sort<null_counter>, sorting_algorithms::tim_sort<std::uint64_t>,
+                merge, count_kind::comparisons, execution::serial, ordering::stable),
+            std::make_tuple("floyd heap",
+                sorting_algorithms::floyd_heap_sort<null_counter>, sorting_algorithms::floyd_heap_sort<std::uint64_t>,
+                heap, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("4-ary heap",
+                sorting_algorithms::aligned_heap_sort<4, false, null_counter>,
+                sorting_algorithms::aligned_heap_sort<4, false, std::uint64_t>,
+                heap, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("8-ary heap",
+                sorting_algorithms::aligned_heap_sort<8, false, null_counter>,
+                sorting_algorithms::aligned_heap_sort<8, false, std::uint64_t>,
+                heap, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("4-ary pf",
+                sorting_algorithms::aligned_heap_sort<4, true, null_counter>,
+                sorting_algorithms::aligned_heap_sort<4, true, std::uint64_t>,
+                heap, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("8-ary pf",
+                sorting_algorithms::aligned_heap_sort<8, true, null_counter>,
+                sorting_algorithms::aligned_heap_sort<8, true, std::uint64_t>,
+                heap, count_kind::comparisons, execution::serial, ordering::unstable),
+            std::make_tuple("sentinel ins",
+                sorting_algorithms::sentinel_insertion_sort<null_counter>,
+                sorting_algorithms::sentinel_insertion_sort<std::uint64_t>,
+                insertion, count_kind::comparisons, execution::serial, ordering::stable),
+            std::make_tuple("binary ins",
+                sorting_algorithms::binary_insertion_sort<null_counter>,
+                sorting_algorithms::binary_insertion_sort<std::uint64_t>,
+                insertion, count_kind::comparisons, execution::serial, ordering::stable),
+            std::make_tuple("intro net",
+                sorting_algorithms::intro_network_sort<null_counter>, sorting_algorithms::intro_network_sort<std::uint64_t>,
+                intro, count_kind::comparisons, execution::serial, ordering::unstable)
+        };
+        return entries;
+    }
+
+    std::array<algorithm_entry_t, sorting_algorithm_count> m_algorithms{algorithm_entries()};
+
+    [[nodiscard]]
+    static task_pool& get_task_pool()
+    {
+        if (!m_task_pool){
+            m_task_pool = std::make_unique<task_pool>(get_thread_count());
+        }
+        return *m_task_pool;
+    }
+
+    /* generated inputs are stream 1 of the seed, the same numbers as the first generated file */
+    void generate_inputs()
+    {
+        m_vec.resize(m_input_size);
+        generate_input_distribution<ValueType>(
+            m_vec, m_distribution.value_or(input_distribution::uniform), random_stream{get_seed(), 1},
+            std::numeric_limits<ValueType>::min(), std::numeric_limits<ValueType>::max(), &get_task_pool()
+        );
+    }
+
+    /*
+     * tests the selected algorithms on the first input_size inputs for every
+     * input size and adds the rows ordered by input size.
+     */
+    void add_results(const std::bitset<sorting_algorithm_count>& algorithm_select,
+                     std::span<const std::int64_t> input_sizes)
+    {
+        std::vector<test_job> jobs;
+        for (auto input_size : input_sizes){
+            for (std::size_t i{}; i < sorting_algorithm_count; ++i){
+                if (algorithm_select[i]){
+                    jobs.push_back(test_job{i, input_size, std::nullopt, 0});
+                }
+            }
+        }
+        std::vector<test_job*> concurrent_jobs;
+        for (auto& job : jobs){
+            if (m_concurrent_jobs > 1 &&
+                std::get<execution>(m_algorithms[job.algorithm]) == execution::serial){
+                concurrent_jobs.push_back(&job);
+                continue;
+            }
+            job.results = perform_test(
+                job.algorithm, std::span{m_vec.data(), static_cast<std::size_t>(job.input_size)}, m_state
+            );
+            job.natural_runs = m_tim_natural_runs;
+        }
+        run_concurrently(concurrent_jobs);
+        for (std::size_t first{}, last{}; first < jobs.size(); first = last){
+            std::array<table::median_time_t, sorting_algorithm_count> median_times{};
+            for (last = first; last < jobs.size() && jobs[last].input_size == jobs[first].input_size; ++last){
+                median_times[jobs[last].algorithm] = std::get<7>(*jobs[last].results);
+            }
+            for (auto job{jobs.begin() + first}; job != jobs.begin() + last; ++job){
+                auto i{job->algorithm};
+                auto& [
+                    algorithm_name,
+                    distribution,
+                    input_size,
+                    test_count,
+                    comparison,
+                    assignment,
+                    allocation,
+                    median_time,
+                    avg_time,
+                    speedup,
+                    memory_traffic,
+                    hardware_counters,
+                    statistics,
+                    cpu_share,
+                    external_times
+                ] = *job->results;
+                auto reference{static_cast<std::size_t>(std::countr_zero(
+                    static_cast<std::uint64_t>(std::get<algorithms>(m_algorithms[i]))
+                ))};
+                if (reference != i && median_times[reference].count() > 0 &&
+                    median_time.count() > 0){
+                    speedup = static_cast<double>(median_times[reference].count()) /
+                              static_cast<double>(median_time.count());
+                }
+                if (1UL << i == tim){
+                    m_natural_runs.emplace_back(m_results.size(), job->natural_runs);
+                }
+                m_comparison_table.add_row(*job->results);
+                m_results.push_back(std::move(*job->results));
+            }
+        }
+    }
+
+    /*
+     * tests the jobs on threads pinned to one cpu each, a job copies its
+     * inputs on the thread that sorts them, so the copy is placed in memory
+     * close to that cpu.
+     */
+    void run_concurrently(std::span<test_job* const> jobs)
+    {
+        if (jobs.empty()){
+            return;
+        }
+        auto cpus{allowed_cpus()};
+        auto worker_count{std::min(static_cast<std::size_t>(m_concurrent_jobs), jobs.size())};
+        if (!cpus.empty()){
+            worker_count = std::min(worker_count, cpus.size());
+            cpus.resize(worker_count);
+        }
+        std::atomic<std::size_t> next_job{};
+        std::atomic<bool> pinned{!cpus.empty()};
+        std::exception_ptr exception;
+        std::mutex exception_mutex;
+        {
+            std::vector<std::jthread> workers;
+            for (std::size_t worker{}; worker < worker_count; ++worker){
+                workers.emplace_back([&, worker](){
+                    if (worker < cpus.size() && !pin_thread(cpus[worker])){
+                        pinned = false;
+                    }
+                    test_state state;
+                    for (auto i{next_job++}; i < jobs.size(); i = next_job++){
+                        try {
+                            auto& job{*jobs[i]};
+                            state.inputs.assign(m_vec.begin(), m_vec.begin() + job.input_size);
+                            job.results = perform_test(job.algorithm, state.inputs, state);
+                            job.natural_runs = m_tim_natural_runs;
+                        } catch (...) {
+                            std::lock_guard lock{exception_mutex};
+                            if (!exception){
+                                exception = std::current_exception();
+                            }
+                        }
+                    }
+                });
+            }
+        }
+        if (exception){
+            std::rethrow_exception(exception);
+        }
+        std::vector<std::uint64_t> job_sizes;
+        for (const auto* job : jobs){
+            job_sizes.push_back(2 * static_cast<std::uint64_t>(job->input_size) * sizeof(ValueType));
+        }
+        std::sort(job_sizes.begin(), job_sizes.end(), std::greater<>{});
+        m_contention.job_count += jobs.size();
+        m_contention.thread_count = std::max(m_contention.thread_count, worker_count);
+        m_contention.cpus = cpus;
+        m_contention.pinned = pinned;
+        m_contention.working_set = std::max(m_contention.working_set, std::accumulate(
+            job_sizes.begin(), job_sizes.begin() + worker_count, std::uint64_t{}
+        ));
+    }
+
+    /* one line per tim sort test from first_row on with the natural runs it found */
+    [[nodiscard]] std::string describe_natural_runs(std::size_t first_row) const
+    {
+        std::string description;
+        for (const auto& [row, runs] : m_natural_runs){
+            if (row < first_row){
+                continue;
+            }
+            const auto& results{m_results[row]};
+            const auto& distribution{std::get<1>(results)};
+            description += std::format(
+                "tim found {} natural run{} in {}{} inputs, {:.1f} inputs per run\n",
+                table::readable(runs), runs == 1 ? "" : "s", table::readable(std::get<2>(results)),
+                distribution == "-" ? "" : " " + distribution,
+                static_cast<double>(std::get<2>(results)) / static_cast<double>(runs)
+            );
+        }
+        return description;
+    }
+
+    /*
+     * tells on which cpus the tests ran concurrently, which test had the
+     * lowest cpu share and whether the inputs of the tests that run at the
+     * same time overflow the last level cache, empty if no test ran
+     * concurrently.
+     */
+    [[nodiscard]] std::string describe_contention(std::size_t first_row) const
+    {
+        if (m_contention.job_count == 0){
+            return {};
+        }
+        std::string cpus;
+        for (auto cpu : m_contention.cpus){
+            cpus += (cpus.empty() ? "" : ", ") + std::to_string(cpu);
+        }
+        auto thread_count{m_contention.thread_count};
+        std::string description{std::format(
+            "{} tests ran concurrently on {} thread{}{}", m_contention.job_count, thread_count,
+            thread_count == 1 ? "" : "s",
+            m_contention.pinned ? (thread_count == 1 ? " pinned to cpu " : " pinned to cpus ") + cpus :
+                                  " that could not be pinned"
+        )};
+        const table::test_results_t* lowest{};
+        for (auto i{first_row}; i < m_results.size(); ++i){
+            const auto& cpu_share{std::get<table::cpu_share_t>(m_results[i])};
+            if (cpu_share && (!lowest || *cpu_share < *std::get<table::cpu_share_t>(*lowest))){
+                lowest = &m_results[i];
+            }
+        }
+        if (lowest){
+            auto cpu_share{*std::get<table::cpu_share_t>(*lowest)};
+            description += std::format(
+                ", the lowest cpu share was {:.1f}% for {} on {} {} inputs", cpu_share * 100.,
+                std::get<0>(*lowest), table::readable(std::get<2>(*lowest)), std::get<1>(*lowest)
+            );
+            if (cpu_share < min_undistorted_cpu_share){
+                description += ", tests below " + std::format("{:.0f}%", min_undistorted_cpu_share * 100.) +
+                               " waited for a cpu and their times are distorted";
+            }
+        }
+        description += "\n";
+        const auto& cache{cache_info::get()};
+        if (cache.l3 > 0 && m_contention.working_set > cache.l3){
+            description += std::format(
+                "the inputs of the concurrent tests take up to {} MiB, more than the {} MiB L3 cache, "
+                "memory bound algorithms may slow each other down, compare with a single job\n",
+                m_contention.working_set >> 20, cache.l3 >> 20
+            );
+        }
+        return description;
+    }
+
+    /*
+     * one line per algorithm and distribution of the rows from first_row on:
+     * the empirical exponent, the closest complexity model and the median
+     * nanoseconds per element while the inputs fit in each cache level.
+     */
+    [[nodiscard]] std::string describe_scaling(std::size_t first_row) const
+    {
+        const auto& cache{cache_info::get()};
+        std::string description{std::format(
+            "L1D {} KiB, L2 {} KiB, L3 {} KiB, an input takes {} bytes\n",
+            cache.l1d >> 10, cache.l2 >> 10, cache.l3 >> 10, sizeof(ValueType)
+        )};
+        std::vector<bool> described(m_results.size());
+        for (auto i{first_row}; i < m_results.size(); ++i){
+            if (described[i]){
+                continue;
+            }
+            const auto& name{std::get<0>(m_results[i])};
+            const auto& distribution{std::get<1>(m_results[i])};
+            std::vector<std::pair<double, double>> sizes_and_times;
+            std::vector<std::pair<std::string_view, std::vector<double>>> levels;
+            for (auto j{i}; j < m_results.size(); ++j){
+                if (std::get<0>(m_results[j]) != name || std::get<1>(m_results[j]) != distribution){
+                    continue;
+                }
+                described[j] = true;
+                auto input_size{std::get<2>(m_results[j])};
+                auto median{static_cast<double>(std::get<7>(m_results[j]).count())};
+                if (median <= 0){
+                    continue;
+                }
+                sizes_and_times.emplace_back(static_cast<double>(input_size), median);
+                auto level{cache.memory_level(input_size * sizeof(ValueType))};
+                if (levels.empty() || levels.back().first != level){
+                    levels.emplace_back(level, std::vector<double>{});
+                }
+                levels.back().second.push_back(median / static_cast<double>(input_size));
+            }
+            if (sizes_and_times.size() < 2){
+                continue;
+            }
+            auto fit{fit_complexity(sizes_and_times)};
+            description += std::format("{} on {} inputs: n^{:.2f}, closest to {} with {:.3g} ns per {}, ns/element",
+                                       name, distribution, fit.exponent, to_string(fit.model),
+                                       fit.constant, to_string(fit.model));
+            for (auto& [level, ns_per_element] : levels){
+                auto middle{ns_per_element.begin() + std::ssize(ns_per_element) / 2};
+                std::nth_element(ns_per_element.begin(), middle, ns_per_element.end());
+                description += std::format(" {} {:.2f}", level, *middle);
+            }
+            description += "\n";
+        }
+        return description;
+    }
 
     void check_argumants(std::int64_t test_count, std::int64_t input_size) const
     {
@@ -265,80 +1115,319 @@ private:
         }
     }
 
-    [[nodiscard]] table::test_results_t
-        perform_test(const algorithm_pair_t& algorithm) const
+    template <std::size_t... Index>
+    void add_record_results(std::size_t payload_size, std::index_sequence<Index...>)
     {
-        auto algorithm_function = std::get<algorithm_signature_t>(algorithm);
-        auto algorithm_name = std::get<table::algorithm_name_t>(algorithm);
-        static std::vector<std::int64_t> time_vec;
-        std::uint64_t comparison{}, assignment{};
-        time_vec.reserve(m_test_count);
+        static_cast<void>(((record_payload_sizes[Index] == payload_size &&
+                            (add_record_results<record_payload_sizes[Index]>(), true)) || ...));
+    }
+
+    template <std::size_t PayloadSize>
+    void add_record_results()
+    {
+        using record_t = record<ValueType, PayloadSize>;
+        std::vector<record_t> inputs(m_input_size);
+        for (std::int64_t i{}; i < m_input_size; ++i){
+            inputs[i].key = m_vec[i];
+            inputs[i].payload = {};
+            std::memcpy(inputs[i].payload.data(), &i, std::min(sizeof(i), PayloadSize));
+        }
+        std::vector<record_t> buffer;
+        record_sort_scratch<record_t> scratch;
+        std::vector<table::test_results_t> rows;
+        for (const auto& [layout, layout_name] : record_layout_names){
+            null_counter no_count{};
+            auto [test_count, statistics, cpu_share, hardware_counters, allocation]{measure_runs(
+                [&](){ buffer = inputs; },
+                [&](){ sort_records(layout, buffer, scratch, no_count, no_count, no_count); },
+                true, m_state.times
+            )};
+            table::comparison_count_t comparison{};
+            table::assignment_count_t assignment{};
+            std::uint64_t bytes{};
+            buffer = inputs;
+            sort_records(layout, buffer, scratch, comparison, assignment, bytes);
+            if (m_verification){
+                verify_records<record_t>(std::format("{} {}B", layout_name, PayloadSize), inputs, buffer);
+            }
+            rows.emplace_back(
+                std::format("{} {}B", layout_name, PayloadSize),
+                m_distribution ? to_string(*m_distribution) : "-", m_input_size, test_count,
+                comparison, assignment, allocation, statistics.median, statistics.mean, table::speedup_t{},
+                table::memory_traffic{
+                    static_cast<double>(bytes) / static_cast<double>(inputs.size() * sizeof(record_t)), bytes
+                },
+                hardware_counters, statistics, cpu_share, table::external_times_t{}
+            );
+        }
+        auto structs_time{std::get<7>(rows.back())};
+        for (auto& row : rows){
+            if (&row != &rows.back() && std::get<7>(row).count() > 0){
+                std::get<9>(row) = static_cast<double>(structs_time.count()) /
+                                   static_cast<double>(std::get<7>(row).count());
+            }
+            m_comparison_table.add_row(row);
+            m_results.push_back(std::move(row));
+        }
+    }
+
+    /* what the timed runs of a test measured */
+    struct run_measurement {
+        std::int64_t test_count;
+        time_statistics statistics;
+        table::cpu_share_t cpu_share;
+        table::hardware_counters_t hardware_counters;
+        table::allocation_count_t allocation;
+    };
+
+    /*
+     * runs prepare and then run for the warm-up runs and the timed runs,
+     * only run is timed. serial runs allocate and run only on the calling
+     * thread, so their allocations and cpu share are counted on it.
+     */
+    template <typename Prepare, typename Run>
+    [[nodiscard]] run_measurement
+        measure_runs(Prepare prepare, Run run, bool serial, std::vector<std::int64_t>& times) const
+    {
+        auto allocation_count = [serial](){
+            return serial ? counting_allocator<ValueType>::get_thread_allocation_count() :
+                            counting_allocator<ValueType>::get_allocation_count();
+        };
+        for (std::int64_t i{}; i < m_warmup_count; ++i){
+            prepare();
+            run();
+        }
+        /* the events are counted on this thread only, which misses the pool workers of a parallel sort */
+        std::optional<perf_counters> counters;
+        if (m_hardware_counters && serial){
+            counters.emplace();
+            counters->reset();
+        }
+        auto allocation{allocation_count()};
+        times.clear();
+        times.reserve(m_test_count);
+        table::ns_t cpu_time{};
+        bool cpu_time_valid{true};
+        auto next_error_check{min_target_error_test_count};
         for (std::int64_t i{}; i < m_test_count; ++i){
-            std::vector<ValueType> temp(begin(m_vec), end(m_vec));
+            prepare();
+            if (counters){
+                counters->start();
+            }
+            auto cpu_start = thread_cpu_time();
             auto start = std::chrono::steady_clock::now();
-            std::invoke(algorithm_function, temp, m_input_size, comparison, assignment);
+            run();
             auto end = std::chrono::steady_clock::now();
-            table::us_t time_interval{
-                std::chrono::duration_cast<table::us_t>(end - start)
-            };
-            time_vec.push_back(time_interval.count());
+            auto cpu_end = thread_cpu_time();
+            if (counters){
+                counters->stop();
+            }
+            times.push_back(std::chrono::duration_cast<table::ns_t>(end - start).count());
+            if (cpu_start && cpu_end){
+                cpu_time += *cpu_end - *cpu_start;
+            } else {
+                cpu_time_valid = false;
+            }
+            /* the error is estimated at geometrically spaced run counts to bound the bootstrap cost */
+            if (m_target_error > 0. && std::ssize(times) >= next_error_check){
+                if (bootstrap_relative_error(times) <= m_target_error){
+                    break;
+                }
+                next_error_check = std::max(next_error_check + 1, std::ssize(times) * 11 / 10);
+            }
         }
-        sort(begin(time_vec), end(time_vec));
-        table::us_t median_us{time_vec[m_test_count / 2]};
-        table::us_t average_us{static_cast<std::int64_t>(
-            accumulate(begin(time_vec), end(time_vec), 0.)/m_test_count
-        )};
-        time_vec.clear();
-        comparison /= m_test_count, assignment /= m_test_count;
-        return std::make_tuple(
-            algorithm_name, m_input_size, m_test_count,
-            comparison, assignment, median_us, average_us
-        );
-    }
-
-    static void
-        selection_sort(std::vector<ValueType>& vec, const std::int64_t& size,
-                       std::uint64_t& comparison, std::uint64_t& assignment)
-    {
-        for (std::int64_t i{}; i < size - 1; ++i){
-            std::int64_t min{i};
-            for (std::int64_t j{i + 1}; j < size; ++j){
-                if (vec[j] < vec[min]){
-                    ++comparison;
-                    min = j;
+        run_measurement measurement{};
+        measurement.test_count = std::ssize(times);
+        auto wall_time{std::accumulate(times.begin(), times.end(), std::int64_t{})};
+        if (serial && cpu_time_valid && wall_time > 0){
+            measurement.cpu_share = std::min(
+                static_cast<double>(cpu_time.count()) / static_cast<double>(wall_time), 1.
+            );
+        }
+        measurement.statistics = summarize(times);
+        measurement.allocation = (allocation_count() - allocation) / measurement.test_count;
+        if (counters){
+            measurement.hardware_counters = counters->read();
+            for (auto& count : measurement.hardware_counters){
+                if (count){
+                    *count /= measurement.test_count;
                 }
             }
-            assignment += 2;
-            std::swap(vec[i], vec[min]);
         }
+        return measurement;
     }
 
-    static void
-        bubble_sort(std::vector<ValueType>& vec, const std::int64_t& size,
-                    std::uint64_t& comparison, std::uint64_t& assignment)
-    {
-        for (std::int64_t i{}; i < size - 1; ++i){
-            for (std::int64_t j{}; j < size - 1 - i; ++j){
-                if (vec[j + 1] < vec[j]){
-                    ++comparison;
-                    assignment += 2;
-                    std::swap(vec[j], vec[j + 1]);
-                }
+    /*
+     * checks the output of the last timed run of an algorithm outside of the
+     * timed region. the output must hold the inputs, compared by a hash of
+     * their multiset, a sort must leave no input smaller than the one before
+     * it and a partial algorithm no selected input greater than the others.
+     * stable comparison sorts also sort inputs with tagged equal keys.
+     */
+    void verify(std::size_t algorithm, std::span<const ValueType> inputs, std::span<const ValueType> output) const
+    {
+        const auto& name{std::get<table::algorithm_name_t>(m_algorithms[algorithm])};
+        auto fail = [&](std::string_view reason){
+            verification_failed(name, reason, std::ssize(inputs));
+        };
+        if (hash_multiset(output) != hash_multiset(inputs)){
+            fail("lost or changed inputs");
+        }
+        auto order{std::get<ordering>(m_algorithms[algorithm])};
+        if (order == ordering::partial){
+            auto selected{output.begin() + selected_count(algorithm, std::ssize(output))};
+            auto greatest{std::max_element(output.begin(), selected)};
+            if (std::any_of(selected, output.end(), [greatest](const ValueType& value){ return value < *greatest; })){
+                fail("did not select the smallest inputs");
+            }
+            return;
+        }
+        if (auto descents{count_descents(output)}; descents > 0){
+            fail(std::format("left {} inputs out of order", table::readable(descents)));
+        }
+        const auto& probe_entry{sorting_algorithms<double>::algorithm_entries()[algorithm]};
+        if (order == ordering::stable &&
+            std::get<sorting_algorithms<double>::count_kind>(probe_entry) ==
+            sorting_algorithms<double>::count_kind::comparisons){
+            auto probe_inputs{make_stability_inputs(
+                static_cast<std::size_t>(std::min(std::ssize(inputs), max_stability_check_size)), get_seed()
+            )};
+            auto probe{probe_inputs};
+            null_counter no_count{};
+            std::invoke(std::get<1>(probe_entry), probe, std::ssize(probe), no_count, no_count);
+            if (!kept_order_of_zeros(probe_inputs, probe)){
+                fail("reordered equal keys in the stability check");
             }
         }
     }
 
-    static void
-        quick_sort(std::vector<ValueType>& vec, const std::int64_t& size,
-                   std::uint64_t& comparison, std::uint64_t& assignment)
+    /*
+     * the keys of the sorted records must be in order and the index in the
+     * payload of every record must point at a different input of its key.
+     */
+    template <typename Record>
+    void verify_records(std::string_view name, std::span<const Record> inputs, std::span<const Record> output) const
     {
-          quick_sort_helper_1(vec, 0, size - 1, comparison, assignment);
+        std::vector<bool> found(inputs.size());
+        for (std::size_t i{}; i < output.size(); ++i){
+            if (i > 0 && output[i].key < output[i - 1].key){
+                verification_failed(name, "left records out of order", std::ssize(inputs));
+            }
+            std::int64_t index{};
+            std::memcpy(&index, output[i].payload.data(), std::min(sizeof(index), output[i].payload.size()));
+            if (index < 0 || index >= std::ssize(inputs) || found[index] ||
+                inputs[index].key < output[i].key || output[i].key < inputs[index].key){
+                verification_failed(name, "separated a payload from its key", std::ssize(inputs));
+            }
+            found[index] = true;
+        }
+    }
+
+    /* reads both files in blocks, the output file must hold the inputs in order */
+    void verify_external(const std::string& input_file, const std::string& output_file) const
+    {
+        std::vector<ValueType> block(external_verification_block_size);
+        auto hash_file = [&block](const std::string& file_name, auto&& visit){
+            typename external_sorter<ValueType>::input_reader reader{file_name};
+            multiset_hash hash{};
+            for (auto count{reader.read(block)}; count > 0; count = reader.read(block)){
+                std::span<const ValueType> values{block.data(), count};
+                hash += hash_multiset(values);
+                visit(values);
+            }
+            return hash;
+        };
+        std::int64_t count{};
+        auto input_hash{hash_file(input_file, [&count](std::span<const ValueType> values){
+            count += std::ssize(values);
+        })};
+        std::uint64_t descents{};
+        std::optional<ValueType> last;
+        auto output_hash{hash_file(output_file, [&descents, &last](std::span<const ValueType> values){
+            descents += count_descents(values) + (last && values.front() < *last);
+            last = values.back();
+        })};
+        if (output_hash != input_hash){
+            verification_failed("external", "lost or changed inputs", count);
+        }
+        if (descents > 0){
+            verification_failed("external", std::format("left {} inputs out of order", table::readable(descents)),
+                                count);
+        }
+    }
+
+    [[noreturn]] static void verification_failed(std::string_view name, std::string_view reason, std::int64_t size)
+    {
+        throw std::runtime_error{std::format(
+            "verification failed, {} {} on {} inputs", name, reason, table::readable(size)
+        )};
+    }
+
+    [[nodiscard]] table::test_results_t
+        perform_test(std::size_t algorithm_index, std::span<const ValueType> inputs, test_state& state) const
+    {
+        const auto& algorithm{m_algorithms[algorithm_index]};
+        auto timed_function = std::get<timed_algorithm_t>(algorithm);
+        auto counted_function = std::get<counted_algorithm_t>(algorithm);
+        auto algorithm_name = std::get<table::algorithm_name_t>(algorithm);
+        const std::int64_t input_size{std::ssize(inputs)};
+        null_counter no_count{};
+        state.buffer.resize(inputs.size());
+        auto [test_count, statistics, cpu_share, hardware_counters, allocation]{measure_runs(
+            [&](){ std::copy(inputs.begin(), inputs.end(), state.buffer.begin()); },
+            [&](){ std::invoke(timed_function, state.buffer, input_size, no_count, no_count); },
+            std::get<execution>(algorithm) == execution::serial, state.times
+        )};
+        if (m_verification){
+            verify(algorithm_index, inputs, state.buffer);
+        }
+        table::comparison_count_t comparison{};
+        table::assignment_count_t assignment{};
+        std::copy(inputs.begin(), inputs.end(), state.buffer.begin());
+        std::invoke(counted_function, state.buffer, input_size, comparison, assignment);
+        table::memory_traffic_t memory_traffic{};
+        if (std::get<count_kind>(algorithm) == count_kind::key_reads){
+            memory_traffic = table::memory_traffic{
+                static_cast<double>(comparison) / static_cast<double>(input_size),
+                (comparison + assignment) * sizeof(ValueType)
+            };
+        }
+        return std::make_tuple(
+            algorithm_name, m_distribution ? to_string(*m_distribution) : "-", input_size, test_count,
+            comparison, assignment, allocation, statistics.median, statistics.mean, table::speedup_t{},
+            memory_traffic, hardware_counters, statistics, cpu_share, table::external_times_t{}
+        );
+    }
+
+    template <operation_counter Counter>
+    static void
+        selection_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                       Counter& comparison, Counter& assignment)
+    {
+        small_sort::selection_sort(std::span{vec.data(), static_cast<std::size_t>(size)}, comparison, assignment);
+    }
+
+    template <operation_counter Counter>
+    static void
+        bubble_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                    Counter& comparison, Counter& assignment)
+    {
+        small_sort::bubble_sort(std::span{vec.data(), static_cast<std::size_t>(size)}, comparison, assignment);
+    }
+
+    template <operation_counter Counter>
+    static void
+        quick_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                   Counter& comparison, Counter& assignment)
+    {
+          quick_sort_helper_1(vec, 0, size - 1, comparison, assignment);
     }
 
+    template <operation_counter Counter>
     static void
         quick_sort_helper_1(
             std::vector<ValueType>& vec, std::int64_t low, std::int64_t high,
-            std::uint64_t& comparison, std::uint64_t& assignment)
+            Counter& comparison, Counter& assignment)
     {
         if (low < high){
             std::int64_t pi{
@@ -349,16 +1438,17 @@ private:
         }
     }
 
+    template <operation_counter Counter>
     [[nodiscard]] static std::int64_t
         quick_sort_helper_2(
             std::vector<ValueType>& vec, std::int64_t low, std::int64_t high,
-            std::uint64_t& comparison, std::uint64_t& assignment)
+            Counter& comparison, Counter& assignment)
     {
         ValueType pivot{vec[high]};
         std::int64_t i{low - 1};
         for (std::int64_t j{low}; j < high; ++j){
+            ++comparison;
             if (vec[j] <= pivot){
-                ++comparison;
                 assignment += 2;
                 i++;
                 std::swap(vec[i], vec[j]);
@@ -369,17 +1459,943 @@ private:
         return (i + 1);
     }
 
+    /*
+     * quick sort that pivots on the median of three or on the ninther, groups
+     * the keys equal to the pivot in the middle, recurses on the smaller side
+     * only and leaves small ranges to insertion sort. ranges that still go
+     * too deep are heap sorted, so the worst case stays O(n log n).
+     */
+    template <operation_counter Counter>
+    static void
+        intro_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                   Counter& comparison, Counter& assignment)
+    {
+        intro_sort_helper_1(vec, 0, size - 1, intro_sort_depth_limit(size),
+                            comparison, assignment);
+    }
+
+    /* intro sort that leaves the small ranges to the sorting networks of small_sort */
+    template <operation_counter Counter>
+    static void
+        intro_network_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                           Counter& comparison, Counter& assignment)
+    {
+        intro_sort_helper_1<base_case::network>(vec, 0, size - 1, intro_sort_depth_limit(size),
+                                                comparison, assignment);
+    }
+
+    [[nodiscard]] static std::int64_t
+        intro_sort_depth_limit(std::int64_t size) noexcept
+    {
+        return 2 * std::bit_width(static_cast<std::uint64_t>(size));
+    }
+
+    /* how the divide and conquer sorts finish the ranges they no longer split */
+    enum class base_case { insertion, network };
+
+    template <base_case BaseCase = base_case::insertion, typename Container, operation_counter Counter>
+    static void
+        intro_sort_helper_1(
+            Container& vec, std::int64_t low, std::int64_t high, std::int64_t depth_limit,
+            Counter& comparison, Counter& assignment)
+    {
+        constexpr std::int64_t cutoff{BaseCase == base_case::network ? network_sort_cutoff : insertion_sort_cutoff};
+        while (high - low + 1 > cutoff){
+            if (depth_limit-- == 0){
+                heap_sort_helper_1(vec, low, high, comparison, assignment);
+                return;
+            }
+            auto [lt, gt]{intro_sort_helper_2(vec, low, high, comparison, assignment)};
+            if (lt - low < high - gt){
+                intro_sort_helper_1<BaseCase>(vec, low, lt - 1, depth_limit, comparison, assignment);
+                low = gt + 1;
+            } else {
+                intro_sort_helper_1<BaseCase>(vec, gt + 1, high, depth_limit, comparison, assignment);
+                high = lt - 1;
+            }
+        }
+        if constexpr (BaseCase == base_case::network){
+            small_sort::network_sort(std::span{vec.data() + low, static_cast<std::size_t>(high - low + 1)},
+                                     comparison, assignment);
+        } else {
+            insertion_sort_helper(vec, low, high, comparison, assignment);
+        }
+    }
+
+    /* dutch national flag partition, returns the range holding the pivot */
+    template <typename Container, operation_counter Counter>
+    [[nodiscard]] static std::pair<std::int64_t, std::int64_t>
+        intro_sort_helper_2(
+            Container& vec, std::int64_t low, std::int64_t high,
+            Counter& comparison, Counter& assignment)
+    {
+        std::int64_t size{high - low + 1};
+        std::int64_t mid{low + size / 2};
+        std::int64_t pivot_index{};
+        if (size > ninther_threshold){
+            std::int64_t step{size / 8};
+            pivot_index = median_of_three(vec,
+                median_of_three(vec, low, low + step, low + 2 * step, comparison),
+                median_of_three(vec, mid - step, mid, mid + step, comparison),
+                median_of_three(vec, high - 2 * step, high - step, high, comparison),
+                comparison
+            );
+        } else {
+            pivot_index = median_of_three(vec, low, mid, high, comparison);
+        }
+        assignment += 3;
+        ValueType pivot{vec[pivot_index]};
+        std::swap(vec[low], vec[pivot_index]);
+        std::int64_t lt{low}, i{low + 1}, gt{high};
+        while (i <= gt){
+            ++comparison;
+            if (vec[i] < pivot){
+                assignment += 2;
+                std::swap(vec[lt++], vec[i++]);
+                continue;
+            }
+            ++comparison;
+            if (pivot < vec[i]){
+                assignment += 2;
+                std::swap(vec[i], vec[gt--]);
+            } else {
+                ++i;
+            }
+        }
+        return {lt, gt};
+    }
+
+    template <typename Container, operation_counter Counter>
+    [[nodiscard]] static std::int64_t
+        median_of_three(const Container& vec, std::int64_t i, std::int64_t j, std::int64_t k,
+                        Counter& comparison)
+    {
+        comparison += 2;
+        if (vec[i] < vec[j]){
+            if (vec[j] < vec[k]){
+                return j;
+            }
+            ++comparison;
+            return vec[i] < vec[k] ? k : i;
+        }
+        if (vec[k] < vec[j]){
+            return j;
+        }
+        ++comparison;
+        return vec[k] < vec[i] ? k : i;
+    }
+
+    /*
+     * pattern-defeating quick sort, partitions in blocks whose comparison
+     * results are stored as offsets first and swapped in bulk afterwards, so
+     * the partition loop has no data dependent branches. a partition that
+     * swapped nothing hints at sorted input and both sides get an insertion
+     * sort that gives up after a few moves. unbalanced partitions shuffle a
+     * few elements and too many of them switch to heap sort.
+     */
+    template <operation_counter Counter>
+    static void
+        pdq_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                 Counter& comparison, Counter& assignment)
+    {
+        pdq_sort_helper_1(vec, 0, size, std::bit_width(static_cast<std::uint64_t>(size)),
+                          true, comparison, assignment);
+    }
+
+    template <operation_counter Counter>
+    static void
+        pdq_sort_helper_1(
+            std::vector<ValueType>& vec, std::int64_t first, std::int64_t last,
+            std::int64_t bad_allowed, bool leftmost,
+            Counter& comparison, Counter& assignment)
+    {
+        for (;;){
+            std::int64_t size{last - first};
+            if (size < pdq_insertion_sort_cutoff){
+                /* the pivot left of a range that is not leftmost is its sentinel */
+                if (leftmost){
+                    insertion_sort_helper(vec, first, last - 1, comparison, assignment);
+                } else {
+                    small_sort::unguarded_insertion_sort(vec.data() + first, vec.data() + last,
+                                                         comparison, assignment);
+                }
+                return;
+            }
+            std::int64_t half{size / 2};
+            if (size > ninther_threshold){
+                sort_three(vec, first, first + half, last - 1, comparison, assignment);
+                sort_three(vec, first + 1, first + half - 1, last - 2, comparison, assignment);
+                sort_three(vec, first + 2, first + half + 1, last - 3, comparison, assignment);
+                sort_three(vec, first + half - 1, first + half, first + half + 1,
+                           comparison, assignment);
+                assignment += 2;
+                std::swap(vec[first], vec[first + half]);
+            } else {
+                sort_three(vec, first + half, first, last - 1, comparison, assignment);
+            }
+            ++comparison;
+            if (!leftmost && !(vec[first - 1] < vec[first])){
+                first = pdq_sort_partition_left(vec, first, last, comparison, assignment) + 1;
+                continue;
+            }
+            auto [pivot_position, already_partitioned]{
+                pdq_sort_partition_right(vec, first, last, comparison, assignment)
+            };
+            std::int64_t left_size{pivot_position - first};
+            std::int64_t right_size{last - pivot_position - 1};
+            if (left_size < size / 8 || right_size < size / 8){
+                if (--bad_allowed == 0){
+                    heap_sort_helper_1(vec, first, last - 1, comparison, assignment);
+                    return;
+                }
+                pdq_sort_break_patterns(vec, first, pivot_position, assignment);
+                pdq_sort_break_patterns(vec, pivot_position + 1, last, assignment);
+            } else if (already_partitioned &&
+                       pdq_sort_partial_insertion_sort(vec, first, pivot_position,
+                                                       comparison, assignment) &&
+                       pdq_sort_partial_insertion_sort(vec, pivot_position + 1, last,
+                                                       comparison, assignment)){
+                return;
+            }
+            pdq_sort_helper_1(vec, first, pivot_position, bad_allowed, leftmost,
+                              comparison, assignment);
+            first = pivot_position + 1;
+            leftmost = false;
+        }
+    }
+
+    /*
+     * partitions vec[first..last) around vec[first], keys equal to the pivot
+     * go to the right. the pivot was chosen as a median so the scans that
+     * look for the first misplaced elements need no bound checks.
+     */
+    template <operation_counter Counter>
+    [[nodiscard]] static std::pair<std::int64_t, bool>
+        pdq_sort_partition_right(
+            std::vector<ValueType>& vec, std::int64_t first, std::int64_t last,
+            Counter& comparison, Counter& assignment)
+    {
+        ValueType pivot{vec[first]};
+        std::int64_t begin{first};
+        ++assignment;
+        do {
+            ++comparison;
+        } while (vec[++first] < pivot);
+        if (first - 1 == begin){
+            while (first < last){
+                ++comparison;
+                if (vec[--last] < pivot){
+                    break;
+                }
+            }
+        } else {
+            do {
+                ++comparison;
+            } while (!(vec[--last] < pivot));
+        }
+        bool already_partitioned{first >= last};
+        if (!already_partitioned){
+            assignment += 2;
+            std::swap(vec[first], vec[last]);
+            ++first;
+            std::array<std::uint8_t, pdq_block_size> offsets_left, offsets_right;
+            std::int64_t left_base{first}, right_base{last};
+            std::int64_t left_count{}, right_count{}, left_start{}, right_start{};
+            while (first < last){
+                std::int64_t unknown{last - first};
+                std::int64_t left_split{
+                    left_count == 0 ? (right_count == 0 ? unknown / 2 : unknown) : 0
+                };
+                std::int64_t right_split{right_count == 0 ? unknown - left_split : 0};
+                left_split = std::min(left_split, pdq_block_size);
+                right_split = std::min(right_split, pdq_block_size);
+                comparison += left_split + right_split;
+                for (std::int64_t i{}; i < left_split; ++i){
+                    offsets_left[left_count] = static_cast<std::uint8_t>(i);
+                    left_count += !(vec[first++] < pivot);
+                }
+                for (std::int64_t i{}; i < right_split;){
+                    offsets_right[right_count] = static_cast<std::uint8_t>(++i);
+                    right_count += (vec[--last] < pivot);
+                }
+                std::int64_t count{std::min(left_count, right_count)};
+                pdq_sort_swap_offsets(vec, left_base, right_base,
+                                      offsets_left.data() + left_start,
+                                      offsets_right.data() + right_start,
+                                      count, left_count == right_count, assignment);
+                left_count -= count, right_count -= count;
+                left_start += count, right_start += count;
+                if (left_count == 0){
+                    left_start = 0;
+                    left_base = first;
+                }
+                if (right_count == 0){
+                    right_start = 0;
+                    right_base = last;
+                }
+            }
+            while (left_count > 0){
+                assignment += 2;
+                --left_count;
+                std::swap(vec[left_base + offsets_left[left_start + left_count]], vec[--last]);
+                first = last;
+            }
+            while (right_count > 0){
+                assignment += 2;
+                --right_count;
+                std::swap(vec[right_base - offsets_right[right_start + right_count]], vec[first++]);
+                last = first;
+            }
+        }
+        std::int64_t pivot_position{first - 1};
+        assignment += 2;
+        vec[begin] = vec[pivot_position];
+        vec[pivot_position] = pivot;
+        return {pivot_position, already_partitioned};
+    }
+
+    template <operation_counter Counter>
+    static void
+        pdq_sort_swap_offsets(
+            std::vector<ValueType>& vec, std::int64_t left_base, std::int64_t right_base,
+            const std::uint8_t* offsets_left, const std::uint8_t* offsets_right,
+            std::int64_t count, bool use_swaps, Counter& assignment)
+    {
+        if (use_swaps){
+            assignment += 2 * count;
+            for (std::int64_t i{}; i < count; ++i){
+                std::swap(vec[left_base + offsets_left[i]], vec[right_base - offsets_right[i]]);
+            }
+        } else if (count > 0){
+            assignment += 2 * count + 1;
+            std::int64_t l{left_base + offsets_left[0]}, r{right_base - offsets_right[0]};
+            ValueType temp{vec[l]};
+            vec[l] = vec[r];
+            for (std::int64_t i{1}; i < count; ++i){
+                l = left_base + offsets_left[i];
+                vec[r] = vec[l];
+                r = right_base - offsets_right[i];
+                vec[l] = vec[r];
+            }
+            vec[r] = temp;
+        }
+    }
+
+    /* keys equal to the pivot go to the left, used when the pivot repeats */
+    template <operation_counter Counter>
+    [[nodiscard]] static std::int64_t
+        pdq_sort_partition_left(
+            std::vector<ValueType>& vec, std::int64_t first, std::int64_t last,
+            Counter& comparison, Counter& assignment)
+    {
+        ValueType pivot{vec[first]};
+        std::int64_t begin{first}, end{last};
+        ++assignment;
+        do {
+            ++comparison;
+        } while (pivot < vec[--last]);
+        if (last + 1 == end){
+            while (first < last){
+                ++comparison;
+                if (pivot < vec[++first]){
+                    break;
+                }
+            }
+        } else {
+            do {
+                ++comparison;
+            } while (!(pivot < vec[++first]));
+        }
+        while (first < last){
+            assignment += 2;
+            std::swap(vec[first], vec[last]);
+            do {
+                ++comparison;
+            } while (pivot < vec[--last]);
+            do {
+                ++comparison;
+            } while (!(pivot < vec[++first]));
+        }
+        assignment += 2;
+        vec[begin] = vec[last];
+        vec[last] = pivot;
+        return last;
+    }
+
+    template <operation_counter Counter>
+    static void
+        pdq_sort_break_patterns(
+            std::vector<ValueType>& vec, std::int64_t first, std::int64_t last,
+            Counter& assignment)
+    {
+        std::int64_t size{last - first};
+        if (size < pdq_insertion_sort_cutoff){
+            return;
+        }
+        std::int64_t quarter{size / 4};
+        assignment += 4;
+        std::swap(vec[first], vec[first + quarter]);
+        std::swap(vec[last - 1], vec[last - quarter]);
+        if (size > ninther_threshold){
+            assignment += 8;
+            std::swap(vec[first + 1], vec[first + quarter + 1]);
+            std::swap(vec[first + 2], vec[first + quarter + 2]);
+            std::swap(vec[last - 2], vec[last - quarter - 1]);
+            std::swap(vec[last - 3], vec[last - quarter - 2]);
+        }
+    }
+
+    /* insertion sort that gives up once it has moved too many elements */
+    template <operation_counter Counter>
+    [[nodiscard]] static bool
+        pdq_sort_partial_insertion_sort(
+            std::vector<ValueType>& vec, std::int64_t first, std::int64_t last,
+            Counter& comparison, Counter& assignment)
+    {
+        std::int64_t moves{};
+        for (std::int64_t i{first + 1}; i < last; ++i){
+            ++comparison;
+            if (vec[i] < vec[i - 1]){
+                ValueType key{vec[i]};
+                std::int64_t j{i};
+                do {
+                    ++assignment;
+                    vec[j] = vec[j - 1];
+                    --j;
+                } while (j > first && (++comparison, key < vec[j - 1]));
+                ++assignment;
+                vec[j] = key;
+                moves += i - j;
+            }
+            if (moves > pdq_partial_insertion_sort_limit){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <operation_counter Counter>
+    static void
+        sort_three(std::vector<ValueType>& vec, std::int64_t i, std::int64_t j, std::int64_t k,
+                   Counter& comparison, Counter& assignment)
+    {
+        sort_two(vec, i, j, comparison, assignment);
+        sort_two(vec, j, k, comparison, assignment);
+        sort_two(vec, i, j, comparison, assignment);
+    }
+
+    template <operation_counter Counter>
+    static void
+        sort_two(std::vector<ValueType>& vec, std::int64_t i, std::int64_t j,
+                 Counter& comparison, Counter& assignment)
+    {
+        ++comparison;
+        if (vec[j] < vec[i]){
+            assignment += 2;
+            std::swap(vec[i], vec[j]);
+        }
+    }
+
+    /*
+     * vectorized quick sort for the key types that have avx2 kernels, falls
+     * back to pdq sort on other key types and on cpus without avx2. ranges
+     * whose keys are all less than or equal to the pivot are split once more
+     * so that the keys equal to the pivot drop out of the recursion.
+     */
+    template <operation_counter Counter>
+    static void
+        simd_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                  Counter& comparison, Counter& assignment)
+    {
+        if constexpr (simd::avx2_sortable<ValueType>){
+            if (simd::avx2_supported()){
+                simd_sort_helper(vec, 0, size, intro_sort_depth_limit(size),
+                                 comparison, assignment);
+                return;
+            }
+        }
+        pdq_sort(vec, size, comparison, assignment);
+    }
+
+    template <operation_counter Counter>
+    static void
+        simd_sort_helper(
+            std::vector<ValueType>& vec, std::int64_t first, std::int64_t last,
+            std::int64_t depth_limit, Counter& comparison, Counter& assignment)
+    requires simd::avx2_sortable<ValueType>
+    {
+        for (;;){
+            std::int64_t size{last - first};
+            if (size <= simd::avx2_block_size<ValueType>){
+                simd::avx2_sort_block(vec.data() + first, size);
+                comparison += simd::avx2_block_comparisons<ValueType>();
+                assignment += 2 * size;
+                return;
+            }
+            if (depth_limit-- == 0){
+                heap_sort_helper_1(vec, first, last - 1, comparison, assignment);
+                return;
+            }
+            std::int64_t step{size / 8}, mid{first + size / 2};
+            ValueType pivot{vec[median_of_three(vec,
+                median_of_three(vec, first, first + step, first + 2 * step, comparison),
+                median_of_three(vec, mid - step, mid, mid + step, comparison),
+                median_of_three(vec, last - 1 - 2 * step, last - 1 - step, last - 1, comparison),
+                comparison
+            )]};
+            auto middle{simd::avx2_partition(vec.data(), first, last, pivot, true)};
+            comparison += size;
+            assignment += size;
+            if (middle == last){
+                last = simd::avx2_partition(vec.data(), first, last, pivot, false);
+                comparison += size;
+                assignment += size;
+                continue;
+            }
+            if (middle - first < last - middle){
+                simd_sort_helper(vec, first, middle, depth_limit, comparison, assignment);
+                first = middle;
+            } else {
+                simd_sort_helper(vec, middle, last, depth_limit, comparison, assignment);
+                last = middle;
+            }
+        }
+    }
+
+    /*
+     * pushes the inputs to a streaming sorter in chunks of stream_chunk_size
+     * and drains them in order, the runs of the sorter are sorted with pdq
+     * sort. lsm_top_k_sort also asks for the stream_top_k smallest values
+     * after every chunk, so its speedup over lsm_stream_sort is the share of
+     * the time left to the pushes when the stream is queried.
+     */
+    template <operation_counter Counter>
+    static void
+        lsm_stream_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                        Counter& comparison, Counter& assignment)
+    {
+        lsm_stream_sort_helper(vec, size, 0, comparison, assignment);
+    }
+
+    template <operation_counter Counter>
+    static void
+        lsm_top_k_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                       Counter& comparison, Counter& assignment)
+    {
+        lsm_stream_sort_helper(vec, size, stream_top_k, comparison, assignment);
+    }
+
+    template <operation_counter Counter>
+    static void
+        lsm_stream_sort_helper(std::vector<ValueType>& vec, const std::int64_t& size, std::size_t top_k,
+                               Counter& comparison, Counter& assignment)
+    {
+        streaming_sorter<ValueType, Counter> sorter{
+            streaming_sorter<ValueType, Counter>::default_buffer_size,
+            streaming_sorter<ValueType, Counter>::default_level_ratio,
+            [](std::vector<ValueType>& run, Counter& run_comparison, Counter& run_assignment){
+                pdq_sort(run, std::ssize(run), run_comparison, run_assignment);
+            }
+        };
+        for (std::int64_t first{}; first < size; first += stream_chunk_size){
+            sorter.push(std::span{
+                vec.data() + first, static_cast<std::size_t>(std::min(stream_chunk_size, size - first))
+            });
+            if (top_k > 0){
+                static_cast<void>(sorter.top_k(top_k));
+            }
+        }
+        auto sorted{sorter.drain()};
+        std::copy(sorted.begin(), sorted.end(), vec.begin());
+        comparison += sorter.get_comparison_count();
+        assignment += sorter.get_assignment_count();
+        assignment += sorted.size();
+    }
+
+    /*
+     * the selection entries order only part of the inputs with the range
+     * algorithms: nth element puts the median in its place with no greater
+     * input before it, the top-k entries move the smallest selection_percent
+     * of the inputs to the front in no order and partial sort sorts them too.
+     * their speedup is over intro sort, which orders all of the inputs.
+     */
+    template <operation_counter Counter>
+    static void
+        nth_element_select(std::vector<ValueType>& vec, const std::int64_t& size,
+                           Counter& comparison, Counter& assignment)
+    {
+        ranges::instrumented(ranges::nth_element, comparison, assignment)(
+            vec.begin(), vec.begin() + size / 2, vec.begin() + size
+        );
+    }
+
+    template <operation_counter Counter>
+    static void
+        partial_sort_select(std::vector<ValueType>& vec, const std::int64_t& size,
+                            Counter& comparison, Counter& assignment)
+    {
+        ranges::instrumented(ranges::partial_sort, comparison, assignment)(
+            vec.begin(), vec.begin() + selection_size(size), vec.begin() + size
+        );
+    }
+
+    template <operation_counter Counter>
+    static void
+        heap_top_k_select(std::vector<ValueType>& vec, const std::int64_t& size,
+                          Counter& comparison, Counter& assignment)
+    {
+        ranges::instrumented(ranges::heap_top_k, comparison, assignment)(
+            vec.begin(), vec.begin() + selection_size(size), vec.begin() + size
+        );
+    }
+
+    template <operation_counter Counter>
+    static void
+        quick_top_k_select(std::vector<ValueType>& vec, const std::int64_t& size,
+                           Counter& comparison, Counter& assignment)
+    {
+        ranges::instrumented(ranges::top_k, comparison, assignment)(
+            vec.begin(), vec.begin() + selection_size(size), vec.begin() + size
+        );
+    }
+
+    [[nodiscard]] static std::int64_t
+        selection_size(std::int64_t size) noexcept
+    {
+        return std::max<std::int64_t>(size * selection_percent / 100, 1);
+    }
+
+    /* how many of the smallest inputs a partial algorithm moves to the front */
+    [[nodiscard]] static std::int64_t
+        selected_count(std::size_t algorithm, std::int64_t size) noexcept
+    {
+        return 1L << algorithm == nth_element ? size / 2 + 1 : selection_size(size);
+    }
+
+    /*
+     * merges the natural runs of the inputs instead of halving them, so its
+     * speedup over merge sort grows with the lengths of the sorted runs the
+     * inputs are made of.
+     */
+    template <operation_counter Counter>
+    static void
+        tim_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                 Counter& comparison, Counter& assignment)
+    {
+        tim_sorter<ValueType, Counter, counting_allocator<ValueType>> sorter;
+        sorter.sort(std::span{vec.data(), static_cast<std::size_t>(size)});
+        m_tim_natural_runs = sorter.get_natural_run_count();
+        comparison += sorter.get_comparison_count();
+        assignment += sorter.get_assignment_count();
+    }
+
+    /*
+     * least significant digit first radix sort, the digit histograms of all
+     * passes are counted in a single read of the input, passes whose digit is
+     * the same for every key are skipped and the others scatter back and
+     * forth between the input and one scratch buffer.
+     */
+    template <operation_counter Counter>
+    static void
+        lsd_radix_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                       Counter& comparison, Counter& assignment)
+    {
+        if constexpr (!radix_sortable){
+            pdq_sort(vec, size, comparison, assignment);
+        } else {
+            constexpr std::int64_t digit_count{sizeof(radix_key_t) * 8 / radix_bits};
+            std::array<std::array<std::int64_t, radix_size>, digit_count> histograms{};
+            for (const auto& value : vec){
+                auto key{radix_key(value)};
+                for (std::int64_t digit{}; digit < digit_count; ++digit){
+                    ++histograms[digit][radix_digit(key, digit)];
+                }
+            }
+            comparison += size;
+            scratch_vector<ValueType> buffer(size);
+            bool in_buffer{false};
+            for (std::int64_t digit{}; digit < digit_count; ++digit){
+                auto& offsets{histograms[digit]};
+                if (offsets[radix_digit(radix_key(vec[0]), digit)] == size){
+                    continue;
+                }
+                std::int64_t sum{};
+                for (auto& offset : offsets){
+                    sum += std::exchange(offset, sum);
+                }
+                if (in_buffer){
+                    lsd_radix_sort_helper(buffer, vec, offsets, digit);
+                } else {
+                    lsd_radix_sort_helper(vec, buffer, offsets, digit);
+                }
+                in_buffer = !in_buffer;
+                comparison += size;
+                assignment += size;
+            }
+            if (in_buffer){
+                copy_run(buffer, vec, 0, size - 1, assignment);
+                comparison += size;
+            }
+        }
+    }
+
+    template <typename Source, typename Destination>
+    static void
+        lsd_radix_sort_helper(const Source& source, Destination& destination,
+                              std::array<std::int64_t, radix_size>& offsets, std::int64_t digit)
+    {
+        for (const auto& value : source){
+            destination[offsets[radix_digit(radix_key(value), digit)]++] = value;
+        }
+    }
+
+    /*
+     * most significant digit first radix sort that permutes every bucket in
+     * place by following cycles (american flag sort), so it needs no buffer.
+     */
+    template <operation_counter Counter>
+    static void
+        msd_radix_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                       Counter& comparison, Counter& assignment)
+    {
+        if constexpr (!radix_sortable){
+            pdq_sort(vec, size, comparison, assignment);
+        } else {
+            msd_radix_sort_helper(vec, 0, size,
+                                  sizeof(radix_key_t) * 8 / radix_bits - 1,
+                                  comparison, assignment);
+        }
+    }
+
+    template <operation_counter Counter>
+    static void
+        msd_radix_sort_helper(
+            std::vector<ValueType>& vec, std::int64_t first, std::int64_t last,
+            std::int64_t digit, Counter& comparison, Counter& assignment)
+    {
+        std::int64_t size{last - first};
+        if (size <= msd_radix_insertion_sort_cutoff){
+            insertion_sort_helper(vec, first, last - 1, comparison, assignment);
+            return;
+        }
+        std::array<std::int64_t, radix_size> heads{}, tails{};
+        for (std::int64_t i{first}; i < last; ++i){
+            ++tails[radix_digit(radix_key(vec[i]), digit)];
+        }
+        std::int64_t sum{first};
+        for (std::int64_t bucket{}; bucket < radix_size; ++bucket){
+            heads[bucket] = sum;
+            sum += tails[bucket];
+            tails[bucket] = sum;
+        }
+        comparison += 2 * size;
+        for (std::int64_t bucket{}; bucket < radix_size; ++bucket){
+            while (heads[bucket] < tails[bucket]){
+                ValueType value{vec[heads[bucket]]};
+                auto value_bucket{radix_digit(radix_key(value), digit)};
+                while (value_bucket != bucket){
+                    ++assignment;
+                    std::swap(value, vec[heads[value_bucket]++]);
+                    value_bucket = radix_digit(radix_key(value), digit);
+                }
+                ++assignment;
+                vec[heads[bucket]++] = value;
+            }
+        }
+        if (digit == 0){
+            return;
+        }
+        std::int64_t bucket_first{first};
+        for (std::int64_t bucket{}; bucket < radix_size; ++bucket){
+            if (tails[bucket] - bucket_first > 1){
+                msd_radix_sort_helper(vec, bucket_first, tails[bucket], digit - 1,
+                                      comparison, assignment);
+            }
+            bucket_first = tails[bucket];
+        }
+    }
+
+    /* maps a key to an unsigned integer that has the same order */
+    [[nodiscard]] static radix_key_t
+        radix_key(const ValueType& value) noexcept
+    {
+        constexpr radix_key_t sign_bit{radix_key_t{1} << (sizeof(radix_key_t) * 8 - 1)};
+        if constexpr (std::unsigned_integral<ValueType>){
+            return value;
+        } else if constexpr (std::signed_integral<ValueType>){
+            return static_cast<radix_key_t>(value) ^ sign_bit;
+        } else {
+            auto key{std::bit_cast<radix_key_t>(value)};
+            return (key & sign_bit) ? ~key : key | sign_bit;
+        }
+    }
+
+    [[nodiscard]] static std::int64_t
+        radix_digit(radix_key_t key, std::int64_t digit) noexcept
+    {
+        return static_cast<std::int64_t>((key >> (digit * radix_bits)) & (radix_size - 1));
+    }
+
+    /*
+     * every block of the input is classified by a thread into buckets bounded
+     * by splitters picked from an oversampled set, each block scatters into its
+     * own region of the buckets and then the buckets are sorted concurrently.
+     * duplicated keys get a bucket of their own that needs no sorting.
+     */
+    template <operation_counter Counter>
+    static void
+        sample_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                    Counter& comparison, Counter& assignment)
+    {
+        auto& pool{get_task_pool()};
+        std::int64_t block_count{static_cast<std::int64_t>(pool.get_thread_count())};
+        if (block_count == 1 || size <= parallel_sort_cutoff){
+            intro_sort(vec, size, comparison, assignment);
+            return;
+        }
+        auto splitters{sample_sort_splitters(
+            vec, size, block_count * sample_sort_buckets_per_thread, comparison, assignment
+        )};
+        std::int64_t bucket_count{2 * std::ssize(splitters) + 1};
+        scratch_vector<std::uint32_t> bucket_of(size);
+        scratch_vector<std::int64_t> offsets(block_count * bucket_count);
+        scratch_vector<std::int64_t> bucket_bounds(bucket_count + 1);
+        scratch_vector<Counter> comparisons(std::max(block_count, bucket_count));
+        scratch_vector<Counter> assignments(std::max(block_count, bucket_count));
+        auto block_bound = [&](std::int64_t block){
+            return size * block / block_count;
+        };
+        {
+            task_pool::task_group group{pool};
+            for (std::int64_t block{}; block < block_count; ++block){
+                group.run([&, block](){
+                    auto histogram{offsets.begin() + block * bucket_count};
+                    for (auto i{block_bound(block)}; i < block_bound(block + 1); ++i){
+                        auto bucket{sample_sort_classify(vec[i], splitters, comparisons[block])};
+                        bucket_of[i] = static_cast<std::uint32_t>(bucket);
+                        ++histogram[bucket];
+                    }
+                });
+            }
+            group.wait();
+        }
+        std::int64_t sum{};
+        for (std::int64_t bucket{}; bucket < bucket_count; ++bucket){
+            bucket_bounds[bucket] = sum;
+            for (std::int64_t block{}; block < block_count; ++block){
+                auto& offset{offsets[block * bucket_count + bucket]};
+                sum += std::exchange(offset, sum);
+            }
+        }
+        bucket_bounds[bucket_count] = sum;
+        scratch_vector<ValueType> buffer(size);
+        {
+            task_pool::task_group group{pool};
+            for (std::int64_t block{}; block < block_count; ++block){
+                group.run([&, block](){
+                    auto offset{offsets.begin() + block * bucket_count};
+                    for (auto i{block_bound(block)}; i < block_bound(block + 1); ++i){
+                        ++assignments[block];
+                        buffer[offset[bucket_of[i]]++] = vec[i];
+                    }
+                });
+            }
+            group.wait();
+        }
+        for (std::int64_t block{}; block < block_count; ++block){
+            comparison += std::exchange(comparisons[block], Counter{});
+            assignment += std::exchange(assignments[block], Counter{});
+        }
+        {
+            task_pool::task_group group{pool};
+            for (std::int64_t bucket{}; bucket < bucket_count; ++bucket){
+                if (bucket_bounds[bucket] == bucket_bounds[bucket + 1]){
+                    continue;
+                }
+                group.run([&, bucket](){
+                    auto low{bucket_bounds[bucket]}, high{bucket_bounds[bucket + 1] - 1};
+                    copy_run(buffer, vec, low, high, assignments[bucket]);
+                    if (bucket % 2 == 0){
+                        intro_sort_helper_1(vec, low, high, intro_sort_depth_limit(high - low + 1),
+                                            comparisons[bucket], assignments[bucket]);
+                    }
+                });
+            }
+            group.wait();
+        }
+        for (std::size_t i{}; i < comparisons.size(); ++i){
+            comparison += comparisons[i];
+            assignment += assignments[i];
+        }
+    }
+
+    template <operation_counter Counter>
+    [[nodiscard]] static scratch_vector<ValueType>
+        sample_sort_splitters(const std::vector<ValueType>& vec, const std::int64_t& size,
+                              std::int64_t bucket_count,
+                              Counter& comparison, Counter& assignment)
+    {
+        std::minstd_rand eng{static_cast<std::minstd_rand::result_type>(size)};
+        std::uniform_int_distribution<std::int64_t> distribution{0, size - 1};
+        scratch_vector<ValueType> samples;
+        samples.reserve(bucket_count * sample_sort_oversampling);
+        for (std::int64_t i{}; i < bucket_count * sample_sort_oversampling; ++i){
+            ++assignment;
+            samples.push_back(vec[distribution(eng)]);
+        }
+        intro_sort_helper_1(samples, 0, std::ssize(samples) - 1,
+                            intro_sort_depth_limit(std::ssize(samples)), comparison, assignment);
+        scratch_vector<ValueType> splitters;
+        splitters.reserve(bucket_count - 1);
+        for (std::int64_t i{1}; i < bucket_count; ++i){
+            auto splitter{samples[i * sample_sort_oversampling]};
+            if (splitters.empty() || splitters.back() < splitter){
+                ++assignment;
+                splitters.push_back(splitter);
+            }
+            ++comparison;
+        }
+        return splitters;
+    }
+
+    /* even buckets hold the keys between two splitters, odd ones the keys equal to a splitter */
+    template <operation_counter Counter>
+    [[nodiscard]] static std::int64_t
+        sample_sort_classify(const ValueType& value, const scratch_vector<ValueType>& splitters,
+                             Counter& comparison)
+    {
+        std::int64_t low{}, high{std::ssize(splitters)};
+        while (low < high){
+            std::int64_t mid{low + (high - low) / 2};
+            ++comparison;
+            if (splitters[mid] <= value){
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low > 0){
+            ++comparison;
+            if (!(splitters[low - 1] < value)){
+                return 2 * low - 1;
+            }
+        }
+        return 2 * low;
+    }
+
+    template <operation_counter Counter>
     static void
         merge_sort(std::vector<ValueType>& vec, const std::int64_t& size,
-                   std::uint64_t& comparison, std::uint64_t& assignment)
+                   Counter& comparison, Counter& assignment)
     {
         merge_sort_helper_1(vec, 0, size - 1, comparison, assignment);
     }
 
+    template <operation_counter Counter>
     static void
         merge_sort_helper_1(
             std::vector<ValueType>& vec, std::int64_t l, std::int64_t r,
-            std::uint64_t& comparison, std::uint64_t& assignment)
+            Counter& comparison, Counter& assignment)
     {
         if (l < r) {
             std::int64_t m{l + (r - l) / 2};
@@ -389,14 +2405,15 @@ private:
         }
     }
 
+    template <operation_counter Counter>
     static void
         merge_sort_helper_2(std::vector<ValueType>& vec,
                             std::int64_t p, std::int64_t q, std::int64_t r,
-                            std::uint64_t& comparison, std::uint64_t& assignment)
+                            Counter& comparison, Counter& assignment)
     {
         std::int64_t n1{q - p + 1};
         std::int64_t n2{r - q};
-        std::vector<ValueType> L, M;
+        scratch_vector<ValueType> L, M;
         L.reserve(n1);
         M.reserve(n2);
         for (std::int64_t i{}; i < n1; ++i){
@@ -432,15 +2449,212 @@ private:
         }
     }
 
+    /*
+     * the inputs are copied to the buffer once and every level merges from
+     * one of them into the other, as in buffered merge sort, so no level
+     * copies its runs back and the sorted inputs end up in vec.
+     */
+    template <operation_counter Counter>
     static void
-        insertion_sort(std::vector<ValueType>& vec, const std::int64_t& size,
-                       std::uint64_t& comparison, std::uint64_t& assignment)
+        parallel_merge_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                            Counter& comparison, Counter& assignment)
+    {
+        auto& pool{get_task_pool()};
+        scratch_vector<ValueType> buffer(size);
+        {
+            auto chunk_count{static_cast<std::int64_t>(pool.get_thread_count())};
+            auto chunk_bound = [&](std::int64_t chunk){
+                return size * chunk / chunk_count;
+            };
+            task_pool::task_group group{pool};
+            for (std::int64_t chunk{}; chunk < chunk_count; ++chunk){
+                group.run([&, chunk](){
+                    std::copy(vec.begin() + chunk_bound(chunk), vec.begin() + chunk_bound(chunk + 1),
+                              buffer.begin() + chunk_bound(chunk));
+                });
+            }
+            group.wait();
+        }
+        assignment += size;
+        parallel_merge_sort_helper_1(vec, buffer, 0, size - 1, pool, comparison, assignment);
+    }
+
+    /* sorts destination[l..r], source[l..r] holds the same elements at the start */
+    template <typename Destination, typename Source, operation_counter Counter>
+    static void
+        parallel_merge_sort_helper_1(
+            Destination& destination, Source& source,
+            std::int64_t l, std::int64_t r, task_pool& pool,
+            Counter& comparison, Counter& assignment)
+    {
+        if (r - l + 1 <= parallel_sort_cutoff || pool.get_thread_count() == 1){
+            buffered_merge_sort_helper(destination, source, l, r, comparison, assignment);
+            return;
+        }
+        std::int64_t m{l + (r - l) / 2};
+        Counter left_comparison{}, left_assignment{};
+        task_pool::task_group group{pool};
+        group.run([&](){
+            parallel_merge_sort_helper_1(source, destination, l, m, pool,
+                                         left_comparison, left_assignment);
+        });
+        parallel_merge_sort_helper_1(source, destination, m + 1, r, pool, comparison, assignment);
+        group.wait();
+        comparison += left_comparison;
+        assignment += left_assignment;
+        parallel_merge_sort_helper_2(source, destination, l, m, r, pool, comparison, assignment);
+    }
+
+    /*
+     * merges source[p..q] and source[q + 1..r] into destination[p..r], the
+     * output is cut into equal chunks and the co-rank of every chunk
+     * boundary tells where each chunk starts in both of the sorted halves.
+     */
+    template <typename Source, typename Destination, operation_counter Counter>
+    static void
+        parallel_merge_sort_helper_2(
+            const Source& source, Destination& destination,
+            std::int64_t p, std::int64_t q, std::int64_t r, task_pool& pool,
+            Counter& comparison, Counter& assignment)
+    {
+        std::int64_t n1{q - p + 1};
+        std::int64_t n2{r - q};
+        std::int64_t chunk_count{std::min<std::int64_t>(
+            static_cast<std::int64_t>(pool.get_thread_count()),
+            (n1 + n2) / parallel_merge_cutoff
+        )};
+        if (chunk_count <= 1){
+            merge_runs(source, destination, p, n1, q + 1, n2, p, comparison, assignment);
+            return;
+        }
+        scratch_vector<Counter> comparisons(chunk_count), assignments(chunk_count);
+        auto chunk_bound = [&](std::int64_t chunk){
+            return (n1 + n2) * chunk / chunk_count;
+        };
+        {
+            task_pool::task_group group{pool};
+            for (std::int64_t chunk{}; chunk < chunk_count; ++chunk){
+                group.run([&, chunk](){
+                    auto& chunk_comparison{comparisons[chunk]};
+                    auto k1{chunk_bound(chunk)}, k2{chunk_bound(chunk + 1)};
+                    auto i1{co_rank(source, k1, p, n1, q + 1, n2, chunk_comparison)};
+                    auto i2{co_rank(source, k2, p, n1, q + 1, n2, chunk_comparison)};
+                    merge_runs(source, destination, p + i1, i2 - i1, q + 1 + k1 - i1,
+                               (k2 - i2) - (k1 - i1), p + k1,
+                               chunk_comparison, assignments[chunk]);
+                });
+            }
+            group.wait();
+        }
+        for (std::size_t i{}; i < comparisons.size(); ++i){
+            comparison += comparisons[i];
+            assignment += assignments[i];
+        }
+    }
+
+    /* how many of the first k merged elements come from the left run */
+    template <typename Container, operation_counter Counter>
+    [[nodiscard]] static std::int64_t
+        co_rank(const Container& vec, std::int64_t k,
+                std::int64_t left, std::int64_t n1,
+                std::int64_t right, std::int64_t n2,
+                Counter& comparison)
+    {
+        std::int64_t low{std::max<std::int64_t>(0, k - n2)};
+        std::int64_t high{std::min(k, n1)};
+        while (low < high){
+            std::int64_t i{low + (high - low) / 2};
+            ++comparison;
+            if (vec[left + i] <= vec[right + k - i - 1]){
+                low = i + 1;
+            } else {
+                high = i;
+            }
+        }
+        return low;
+    }
+
+    template <typename Source, typename Destination, operation_counter Counter>
+    static void
+        merge_runs(const Source& source, Destination& destination,
+                   std::int64_t left, std::int64_t n1,
+                   std::int64_t right, std::int64_t n2, std::int64_t k,
+                   Counter& comparison, Counter& assignment)
     {
-        for (std::int64_t i{1}; i < size; ++i) {
+        std::int64_t i{}, j{};
+        while (i < n1 && j < n2){
+            ++comparison;
+            ++assignment;
+            if (source[left + i] <= source[right + j]){
+                destination[k] = source[left + i];
+                i++;
+            } else {
+                destination[k] = source[right + j];
+                j++;
+            }
+            k++;
+        }
+        while (i < n1){
+            ++assignment;
+            destination[k++] = source[left + i++];
+        }
+        while (j < n2){
+            ++assignment;
+            destination[k++] = source[right + j++];
+        }
+    }
+
+    template <typename Source, typename Destination, operation_counter Counter>
+    static void
+        copy_run(const Source& source, Destination& destination,
+                 std::int64_t l, std::int64_t r, Counter& assignment)
+    {
+        for (std::int64_t i{l}; i <= r; ++i){
+            ++assignment;
+            destination[i] = source[i];
+        }
+    }
+
+    /*
+     * top-down merge sort with a single scratch buffer, both arrays hold the
+     * same elements at the start and every level merges from one into the other
+     * so the sorted halves never have to be copied back.
+     */
+    template <operation_counter Counter>
+    static void
+        buffered_merge_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                            Counter& comparison, Counter& assignment)
+    {
+        scratch_vector<ValueType> buffer(begin(vec), end(vec));
+        assignment += size;
+        buffered_merge_sort_helper(vec, buffer, 0, size - 1, comparison, assignment);
+    }
+
+    template <typename Destination, typename Source, operation_counter Counter>
+    static void
+        buffered_merge_sort_helper(
+            Destination& destination, Source& source, std::int64_t l, std::int64_t r,
+            Counter& comparison, Counter& assignment)
+    {
+        if (l < r){
+            std::int64_t m{l + (r - l) / 2};
+            buffered_merge_sort_helper(source, destination, l, m, comparison, assignment);
+            buffered_merge_sort_helper(source, destination, m + 1, r, comparison, assignment);
+            merge_runs(source, destination, l, m - l + 1, m + 1, r - m, l,
+                       comparison, assignment);
+        }
+    }
+
+    template <typename Container, operation_counter Counter>
+    static void
+        insertion_sort_helper(
+            Container& vec, std::int64_t low, std::int64_t high,
+            Counter& comparison, Counter& assignment)
+    {
+        for (std::int64_t i{low + 1}; i <= high; ++i){
             ValueType key{vec[i]};
             std::int64_t j{i - 1};
-            while (key < vec[j] && j >= 0) {
-                ++comparison;
+            while (j >= low && (++comparison, key < vec[j])){
                 ++assignment;
                 vec[j + 1] = vec[j];
                 --j;
@@ -450,40 +2664,113 @@ private:
         }
     }
 
+    template <operation_counter Counter>
+    static void
+        insertion_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                       Counter& comparison, Counter& assignment)
+    {
+        insertion_sort_helper(vec, 0, size - 1, comparison, assignment);
+    }
+
+    /*
+     * the insertion sorts of small_sort, both against insertion sort. the
+     * sentinel one moves the smallest input to the front first so that its
+     * inner loop needs no bound check, the binary one searches for the place
+     * of every input and moves the inputs after it at once.
+     */
+    template <operation_counter Counter>
+    static void
+        sentinel_insertion_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                                Counter& comparison, Counter& assignment)
+    {
+        small_sort::sentinel_insertion_sort(std::span{vec.data(), static_cast<std::size_t>(size)},
+                                            comparison, assignment);
+    }
+
+    template <operation_counter Counter>
+    static void
+        binary_insertion_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                              Counter& comparison, Counter& assignment)
+    {
+        small_sort::binary_insertion_sort(std::span{vec.data(), static_cast<std::size_t>(size)}, 0,
+                                          comparison, assignment);
+    }
+
+    template <operation_counter Counter>
     static void
         heap_sort(std::vector<ValueType>& vec, const std::int64_t& size,
-                  std::uint64_t& comparison, std::uint64_t& assignment)
+                  Counter& comparison, Counter& assignment)
     {
+        heap_sort_helper_1(vec, 0, size - 1, comparison, assignment);
+    }
+
+    template <typename Container, operation_counter Counter>
+    static void
+        heap_sort_helper_1(
+            Container& vec, std::int64_t low, std::int64_t high,
+            Counter& comparison, Counter& assignment)
+    {
+        std::int64_t size{high - low + 1};
         for (std::int64_t i{size / 2 - 1}; i >= 0; --i){
-            heap_sort_helper(vec, size, i, comparison, assignment);
+            heap_sort_helper_2(vec, low, size, i, comparison, assignment);
         }
         for (std::int64_t i{size - 1}; i >= 0; --i) {
             assignment += 2;
-            std::swap(vec[0], vec[i]);
-            heap_sort_helper(vec, i, 0, comparison, assignment);
+            std::swap(vec[low], vec[low + i]);
+            heap_sort_helper_2(vec, low, i, 0, comparison, assignment);
         }
     }
 
+    /*
+     * the heap sorts of d_ary_heap, all against heap sort. floyd heap sorts
+     * the binary heap in place, the wider heaps are copied to a buffer where
+     * the children of every node start on a multiple of their size in bytes,
+     * so they share a cache line, and the pf entries also prefetch the
+     * grandchildren of the nodes they sift through.
+     */
+    template <operation_counter Counter>
+    static void
+        floyd_heap_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                        Counter& comparison, Counter& assignment)
+    {
+        d_ary_heap::sort<2, false>(
+            std::span{vec.data(), static_cast<std::size_t>(size)}, vec.data(), comparison, assignment
+        );
+    }
+
+    template <std::size_t Arity, bool Prefetch, operation_counter Counter>
     static void
-        heap_sort_helper(
-            std::vector<ValueType>& vec, const std::int64_t& size, std::int64_t i,
-            std::uint64_t& comparison, std::uint64_t& assignment)
+        aligned_heap_sort(std::vector<ValueType>& vec, const std::int64_t& size,
+                          Counter& comparison, Counter& assignment)
+    {
+        std::span values{vec.data(), static_cast<std::size_t>(size)};
+        scratch_vector<ValueType> buffer;
+        auto heap{d_ary_heap::aligned_heap<Arity>(buffer, values.size())};
+        std::copy(values.begin(), values.end(), heap);
+        assignment += size;
+        d_ary_heap::sort<Arity, Prefetch>(values, heap, comparison, assignment);
+    }
+
+    /* sifts down the i-th node of the heap stored in vec[low..low + size) */
+    template <typename Container, operation_counter Counter>
+    static void
+        heap_sort_helper_2(
+            Container& vec, std::int64_t low, const std::int64_t& size, std::int64_t i,
+            Counter& comparison, Counter& assignment)
     {
         std::int64_t largest{i};
         std::int64_t left{2 * i + 1};
         std::int64_t right{2 * i + 2};
-        if (left < size && vec[left] > vec[largest]){
-            ++comparison;
+        if (left < size && (++comparison, vec[low + left] > vec[low + largest])){
             largest = left;
         }
-        if (right < size && vec[right] > vec[largest]){
-            ++comparison;
+        if (right < size && (++comparison, vec[low + right] > vec[low + largest])){
             largest = right;
         }
         if (largest != i) {
             assignment += 2;
-            std::swap(vec[i], vec[largest]);
-            heap_sort_helper(vec, size, largest, comparison, assignment);
+            std::swap(vec[low + i], vec[low + largest]);
+            heap_sort_helper_2(vec, low, size, largest, comparison, assignment);
         }
     }
 };
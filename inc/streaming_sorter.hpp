@@ -0,0 +1,273 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef STREAMING_SORTER_HPP
+#define STREAMING_SORTER_HPP
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+
+#include <operation_counter.hpp>
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+/*
+ * sorts values that arrive in chunks, like a log structured merge tree.
+ * pushed values are collected unsorted and are only sorted when a query
+ * needs them or the buffer is full. a full buffer is merged into the first
+ * level, and a level that outgrows its capacity, ratio times the capacity
+ * of the level above, is merged into the next one, so every level holds a
+ * single sorted run and each value is merged about ratio times per level.
+ * queries merge the few runs on the fly or compact them into one.
+ */
+template <algorithm_value_type ValueType, operation_counter Counter = null_counter>
+class streaming_sorter {
+public:
+    using run_t = std::vector<ValueType>;
+    using run_sorter_t = std::function<void(run_t&, Counter&, Counter&)>;
+
+    static constexpr std::size_t default_buffer_size = 1UL << 12;
+    static constexpr std::size_t default_level_ratio = 8;
+
+    explicit streaming_sorter(std::size_t buffer_size = default_buffer_size,
+                              std::size_t level_ratio = default_level_ratio,
+                              run_sorter_t run_sorter = sort_run)
+        : m_buffer_size{buffer_size},
+        m_level_ratio{level_ratio},
+        m_run_sorter{std::move(run_sorter)}
+    {
+        if (m_buffer_size == 0){
+            throw std::runtime_error{"buffer size of the streaming sorter cannot be zero"};
+        }
+        if (m_level_ratio < 2){
+            throw std::runtime_error{"level ratio of the streaming sorter cannot be smaller than 2"};
+        }
+    }
+
+    void push(std::span<const ValueType> chunk)
+    {
+        m_arrivals.insert(m_arrivals.end(), chunk.begin(), chunk.end());
+        m_assignment += chunk.size();
+        m_size += chunk.size();
+        if (m_buffer.size() + m_arrivals.size() >= m_buffer_size){
+            sort_arrivals();
+            compact(std::exchange(m_buffer, {}));
+        }
+    }
+
+    /* the k smallest values in order, merged from the heads of the runs without compacting them */
+    [[nodiscard]]
+    run_t top_k(std::size_t k)
+    {
+        sort_arrivals();
+        std::vector<std::span<const ValueType>> runs;
+        for (auto run{m_levels.rbegin()}; run != m_levels.rend(); ++run){
+            if (!run->empty()){
+                runs.emplace_back(run->data(), std::min(run->size(), k));
+            }
+        }
+        if (!m_buffer.empty()){
+            runs.emplace_back(m_buffer.data(), std::min(m_buffer.size(), k));
+        }
+        run_t smallest;
+        smallest.reserve(std::min(k, m_size));
+        merge_runs(runs, smallest, k);
+        return smallest;
+    }
+
+    /* all values in order, valid until the next push or drain */
+    [[nodiscard]]
+    std::span<const ValueType> merged_view()
+    {
+        sort_arrivals();
+        if (m_levels.empty() && m_buffer.empty()){
+            return {};
+        }
+        std::vector<std::span<const ValueType>> runs;
+        for (auto run{m_levels.rbegin()}; run != m_levels.rend(); ++run){
+            if (!run->empty()){
+                runs.emplace_back(*run);
+            }
+        }
+        if (!m_buffer.empty()){
+            runs.emplace_back(m_buffer);
+        }
+        if (runs.size() > 1){
+            run_t merged;
+            merged.reserve(m_size);
+            merge_runs(runs, merged, m_size);
+            m_buffer.clear();
+            for (auto& run : m_levels){
+                run.clear();
+            }
+            m_levels.resize(level_of(merged.size()) + 1);
+            m_levels.back() = std::move(merged);
+        } else if (!m_buffer.empty()){
+            m_levels.resize(level_of(m_buffer.size()) + 1);
+            m_levels.back() = std::exchange(m_buffer, {});
+        }
+        return m_levels.back();
+    }
+
+    /* all values in order, the sorter is left empty */
+    [[nodiscard]]
+    run_t drain()
+    {
+        if (merged_view().empty()){
+            return {};
+        }
+        run_t values{std::move(m_levels.back())};
+        m_levels.clear();
+        m_size = 0;
+        return values;
+    }
+
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    [[nodiscard]]
+    std::size_t get_level_count() const noexcept
+    {
+        return m_levels.size();
+    }
+
+    [[nodiscard]]
+    const Counter& get_comparison_count() const noexcept
+    {
+        return m_comparison;
+    }
+
+    [[nodiscard]]
+    const Counter& get_assignment_count() const noexcept
+    {
+        return m_assignment;
+    }
+
+private:
+    std::size_t m_buffer_size;
+    std::size_t m_level_ratio;
+    run_sorter_t m_run_sorter;
+    /* pushed values that are not sorted yet */
+    run_t m_arrivals;
+    /* the sorted values that are not merged into a level yet */
+    run_t m_buffer;
+    std::vector<run_t> m_levels;
+    std::size_t m_size{};
+    Counter m_comparison{};
+    Counter m_assignment{};
+
+    static void sort_run(run_t& run, Counter& comparison, Counter&)
+    {
+        std::sort(run.begin(), run.end(), [&comparison](const ValueType& a, const ValueType& b){
+            ++comparison;
+            return a < b;
+        });
+    }
+
+    [[nodiscard]]
+    std::size_t capacity(std::size_t level) const noexcept
+    {
+        auto capacity{m_buffer_size * m_level_ratio};
+        for (std::size_t i{}; i < level; ++i){
+            capacity *= m_level_ratio;
+        }
+        return capacity;
+    }
+
+    /* the first level whose capacity holds size values */
+    [[nodiscard]]
+    std::size_t level_of(std::size_t size) const noexcept
+    {
+        std::size_t level{};
+        while (capacity(level) < size){
+            ++level;
+        }
+        return level;
+    }
+
+    void sort_arrivals()
+    {
+        if (m_arrivals.empty()){
+            return;
+        }
+        m_run_sorter(m_arrivals, m_comparison, m_assignment);
+        if (m_buffer.empty()){
+            std::swap(m_buffer, m_arrivals);
+            return;
+        }
+        m_buffer = merge_two(m_buffer, m_arrivals);
+        m_arrivals.clear();
+    }
+
+    /* merges run into the first level and pushes the levels over their capacity down */
+    void compact(run_t run)
+    {
+        for (std::size_t level{}; !run.empty(); ++level){
+            if (level == m_levels.size()){
+                m_levels.emplace_back();
+            }
+            if (!m_levels[level].empty()){
+                run = merge_two(m_levels[level], run);
+                m_levels[level].clear();
+            }
+            if (run.size() <= capacity(level)){
+                m_levels[level] = std::move(run);
+                return;
+            }
+        }
+    }
+
+    /* equal values keep the order of the runs, older runs first */
+    [[nodiscard]]
+    run_t merge_two(std::span<const ValueType> older, std::span<const ValueType> newer)
+    {
+        run_t merged(older.size() + newer.size());
+        std::size_t i{}, j{}, k{};
+        while (i < older.size() && j < newer.size()){
+            ++m_comparison;
+            merged[k++] = newer[j] < older[i] ? newer[j++] : older[i++];
+        }
+        std::copy(older.begin() + i, older.end(), merged.begin() + k);
+        std::copy(newer.begin() + j, newer.end(), merged.begin() + k + (older.size() - i));
+        m_assignment += merged.size();
+        return merged;
+    }
+
+    /*
+     * there is a run per level, few enough to find the smallest head by a
+     * linear scan. the runs come oldest first, the deepest level first and
+     * the buffer last, so equal values keep the order of the runs as in
+     * merge_two.
+     */
+    void merge_runs(std::vector<std::span<const ValueType>>& runs, run_t& out, std::size_t count)
+    {
+        while (out.size() < count && !runs.empty()){
+            std::size_t smallest{};
+            for (std::size_t i{1}; i < runs.size(); ++i){
+                ++m_comparison;
+                if (runs[i].front() < runs[smallest].front()){
+                    smallest = i;
+                }
+            }
+            out.push_back(runs[smallest].front());
+            ++m_assignment;
+            runs[smallest] = runs[smallest].subspan(1);
+            if (runs[smallest].empty()){
+                runs.erase(runs.begin() + static_cast<std::ptrdiff_t>(smallest));
+            }
+        }
+    }
+};
+
+} /* namespace algorithms */
+
+#endif /* STREAMING_SORTER_HPP */
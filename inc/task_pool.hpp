@@ -0,0 +1,217 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef TASK_POOL_HPP
+#define TASK_POOL_HPP
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace algorithms {
+
+/*
+ * work-stealing thread pool, every worker owns a deque, pushes and pops at
+ * its back and steals from the front of the others. threads that are not
+ * workers of the pool share the first deque. a thread waiting on a
+ * task_group executes pending tasks instead of blocking, so nested fork/join
+ * never deadlocks even if the pool has no workers at all.
+ */
+class task_pool {
+public:
+    using task_t = std::function<void()>;
+
+    class task_group {
+    public:
+        explicit task_group(task_pool& pool) noexcept
+            : m_pool{pool} { }
+
+        task_group(const task_group&) = delete;
+        task_group& operator=(const task_group&) = delete;
+
+        ~task_group()
+        {
+            while (m_pending.load(std::memory_order_acquire) > 0){
+                if (!m_pool.try_run_one()){
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        template <typename Function>
+        void run(Function&& function)
+        {
+            m_pending.fetch_add(1, std::memory_order_relaxed);
+            m_pool.push(
+                [this, function = std::forward<Function>(function)]() mutable {
+                    try {
+                        function();
+                    } catch (...) {
+                        std::lock_guard lock{m_exception_mutex};
+                        if (!m_exception){
+                            m_exception = std::current_exception();
+                        }
+                    }
+                    m_pending.fetch_sub(1, std::memory_order_release);
+                }
+            );
+        }
+
+        void wait()
+        {
+            while (m_pending.load(std::memory_order_acquire) > 0){
+                if (!m_pool.try_run_one()){
+                    std::this_thread::yield();
+                }
+            }
+            if (m_exception){
+                std::rethrow_exception(std::exchange(m_exception, nullptr));
+            }
+        }
+
+    private:
+        task_pool& m_pool;
+        std::atomic<std::int64_t> m_pending{};
+        std::mutex m_exception_mutex;
+        std::exception_ptr m_exception{};
+    };
+
+    explicit task_pool(std::size_t thread_count = std::thread::hardware_concurrency())
+        : m_thread_count{thread_count == 0 ? 1 : thread_count},
+        m_queues(m_thread_count)
+    {
+        m_workers.reserve(m_thread_count - 1);
+        for (std::size_t i{1}; i < m_thread_count; ++i){
+            m_workers.emplace_back([this, i](){ worker_loop(i); });
+        }
+    }
+
+    task_pool(const task_pool&) = delete;
+    task_pool& operator=(const task_pool&) = delete;
+
+    ~task_pool()
+    {
+        {
+            std::lock_guard lock{m_sleep_mutex};
+            m_stop = true;
+        }
+        m_sleep_cv.notify_all();
+        for (auto& worker : m_workers){
+            worker.join();
+        }
+    }
+
+    [[nodiscard]]
+    std::size_t get_thread_count() const noexcept
+    {
+        return m_thread_count;
+    }
+
+    [[nodiscard]]
+    bool try_run_one()
+    {
+        task_t task;
+        if (!try_pop(task)){
+            return false;
+        }
+        task();
+        return true;
+    }
+
+private:
+    struct task_queue {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    std::size_t m_thread_count;
+    std::vector<task_queue> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<std::int64_t> m_queued{};
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
+    bool m_stop{};
+
+    inline static thread_local const task_pool* tl_pool{};
+    inline static thread_local std::size_t tl_index{};
+
+    [[nodiscard]]
+    std::size_t current_index() const noexcept
+    {
+        return tl_pool == this ? tl_index : 0;
+    }
+
+    void push(task_t task)
+    {
+        auto& queue{m_queues[current_index()]};
+        {
+            std::lock_guard lock{queue.mutex};
+            queue.tasks.push_back(std::move(task));
+        }
+        m_queued.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard lock{m_sleep_mutex};
+        }
+        m_sleep_cv.notify_one();
+    }
+
+    [[nodiscard]]
+    bool try_pop(task_t& task)
+    {
+        if (m_queued.load(std::memory_order_acquire) <= 0){
+            return false;
+        }
+        const auto own{current_index()};
+        {
+            auto& queue{m_queues[own]};
+            std::lock_guard lock{queue.mutex};
+            if (!queue.tasks.empty()){
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (std::size_t i{1}; i < m_thread_count; ++i){
+            auto& queue{m_queues[(own + i) % m_thread_count]};
+            std::lock_guard lock{queue.mutex};
+            if (!queue.tasks.empty()){
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(std::size_t index)
+    {
+        tl_pool = this;
+        tl_index = index;
+        for (;;){
+            if (try_run_one()){
+                continue;
+            }
+            std::unique_lock lock{m_sleep_mutex};
+            m_sleep_cv.wait(lock, [this](){
+                return m_stop || m_queued.load(std::memory_order_acquire) > 0;
+            });
+            if (m_stop){
+                return;
+            }
+        }
+    }
+};
+
+} /* namespace algorithms */
+
+#endif /* TASK_POOL_HPP */
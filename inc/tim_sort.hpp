@@ -0,0 +1,380 @@
+/* SPDX-FileCopyrightText: Copyright (c) 2022-2025 Oğuz Toraman <oguz.toraman@tutanota.com> */
+/* SPDX-License-Identifier: BSL-1.0 */
+
+#ifndef TIM_SORT_HPP
+#define TIM_SORT_HPP
+
+#include <span>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <concepts>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+
+#include <small_sort.hpp>
+#include <operation_counter.hpp>
+#include <algorithm_concepts.hpp>
+
+namespace algorithms {
+
+/*
+ * the length of the natural run at the front of values and whether it is
+ * descending. a descending run is strictly descending, so reversing it
+ * keeps equal values in order.
+ */
+template <typename ValueType, operation_counter Counter, typename Less = std::ranges::less>
+[[nodiscard]] std::pair<std::size_t, bool>
+    natural_run_length(std::span<const ValueType> values, Counter& comparison, Less less = {})
+{
+    if (values.size() < 2){
+        return {values.size(), false};
+    }
+    std::size_t length{2};
+    ++comparison;
+    if (less(values[1], values[0])){
+        for (; length < values.size(); ++length){
+            ++comparison;
+            if (!less(values[length], values[length - 1])){
+                break;
+            }
+        }
+        return {length, true};
+    }
+    for (; length < values.size(); ++length){
+        ++comparison;
+        if (less(values[length], values[length - 1])){
+            break;
+        }
+    }
+    return {length, false};
+}
+
+/*
+ * an adaptive merge sort. natural runs are found from left to right,
+ * descending ones are reversed, and a run shorter than the minimum run is
+ * extended with binary insertion sort. the runs are kept on a stack and
+ * merged by the powersort policy: the boundary between two runs gets the
+ * depth of their midpoints in a perfectly balanced merge tree, and runs
+ * are merged while the boundary below the top is deeper than the new one,
+ * which is within a few percent of the optimal merge cost. a merge first
+ * skips the values already in place at both ends, copies the shorter run
+ * to a buffer and switches to galloping, exponential searches for where
+ * the next value of one run goes in the other, once a run wins min_gallop
+ * times in a row. min_gallop grows when galloping does not pay off.
+ * the values are ordered by comp on their projections, so the ranges
+ * stable sort can order records by a key.
+ */
+template <std::movable ValueType, operation_counter Counter = null_counter,
+          typename Allocator = std::allocator<ValueType>,
+          typename Comp = std::ranges::less, typename Proj = std::identity>
+class tim_sorter {
+public:
+    static constexpr std::size_t initial_min_gallop = 7;
+
+    tim_sorter() = default;
+
+    explicit tim_sorter(Comp comp, Proj proj = {})
+        : m_comp{std::move(comp)}, m_proj{std::move(proj)} { }
+
+    void sort(std::span<ValueType> values)
+    {
+        const auto size{values.size()};
+        const auto min_run{minimum_run(size)};
+        m_runs.clear();
+        m_buffer.reserve(size / 2);
+        m_min_gallop = initial_min_gallop;
+        m_natural_run_count = 0;
+        for (std::size_t first{}; first < size;){
+            auto [length, descending]{
+                natural_run_length(std::span<const ValueType>{values.subspan(first)}, m_comparison, ordering())
+            };
+            ++m_natural_run_count;
+            if (descending){
+                std::reverse(values.begin() + first, values.begin() + first + length);
+                m_assignment += length / 2 * 2;
+            }
+            if (length < min_run){
+                auto extended{std::min(min_run, size - first)};
+                small_sort::binary_insertion_sort(values.subspan(first, extended), length,
+                                                  m_comparison, m_assignment, ordering());
+                length = extended;
+            }
+            push_run(values, first, length);
+            first += length;
+        }
+        while (m_runs.size() > 1){
+            merge_top(values);
+        }
+    }
+
+    /* the natural runs the last sort found before extending them to the minimum run */
+    [[nodiscard]]
+    std::size_t get_natural_run_count() const noexcept
+    {
+        return m_natural_run_count;
+    }
+
+    [[nodiscard]]
+    const Counter& get_comparison_count() const noexcept
+    {
+        return m_comparison;
+    }
+
+    [[nodiscard]]
+    const Counter& get_assignment_count() const noexcept
+    {
+        return m_assignment;
+    }
+
+    /* between 32 and 64, so that size / minimum run is a power of two or a little less */
+    [[nodiscard]]
+    static constexpr std::size_t minimum_run(std::size_t size) noexcept
+    {
+        std::size_t low_bit{};
+        while (size >= 64){
+            low_bit |= size & 1;
+            size >>= 1;
+        }
+        return size + low_bit;
+    }
+
+private:
+    struct run {
+        std::size_t first;
+        std::size_t length;
+        /* the depth of the boundary after the run, set once the next run is found */
+        std::size_t power;
+    };
+
+    std::vector<run> m_runs;
+    std::vector<ValueType, Allocator> m_buffer;
+    std::size_t m_min_gallop{initial_min_gallop};
+    std::size_t m_natural_run_count{};
+    Counter m_comparison{};
+    Counter m_assignment{};
+    [[no_unique_address]] Comp m_comp{};
+    [[no_unique_address]] Proj m_proj{};
+
+    [[nodiscard]]
+    bool less(const ValueType& a, const ValueType& b)
+    {
+        return std::invoke(m_comp, std::invoke(m_proj, a), std::invoke(m_proj, b));
+    }
+
+    [[nodiscard]]
+    auto ordering() noexcept
+    {
+        return [this](const ValueType& a, const ValueType& b){ return less(a, b); };
+    }
+
+    /*
+     * the first level at which the midpoints of the two runs, as fractions
+     * of size, fall on different sides of a power of two division.
+     */
+    [[nodiscard]]
+    static std::size_t node_power(std::size_t size, std::size_t first, std::size_t length,
+                                  std::size_t next_length) noexcept
+    {
+        auto a{2 * first + length};
+        auto b{a + length + next_length};
+        std::size_t power{};
+        for (;;){
+            ++power;
+            if (a >= size){
+                a -= size;
+                b -= size;
+            } else if (b >= size){
+                break;
+            }
+            a <<= 1;
+            b <<= 1;
+        }
+        return power;
+    }
+
+    void push_run(std::span<ValueType> values, std::size_t first, std::size_t length)
+    {
+        if (!m_runs.empty()){
+            auto power{node_power(values.size(), m_runs.back().first, m_runs.back().length, length)};
+            while (m_runs.size() > 1 && m_runs[m_runs.size() - 2].power > power){
+                merge_top(values);
+            }
+            m_runs.back().power = power;
+        }
+        m_runs.push_back(run{first, length, 0});
+    }
+
+    void merge_top(std::span<ValueType> values)
+    {
+        auto right{m_runs.back()};
+        m_runs.pop_back();
+        auto& left{m_runs.back()};
+        merge(values.data() + left.first, values.data() + right.first, values.data() + right.first + right.length);
+        left.length += right.length;
+        left.power = right.power;
+    }
+
+    /* the first position in [first, last) where pred turns false, pred is true for a prefix */
+    template <typename Iterator, typename Pred>
+    [[nodiscard]]
+    static Iterator gallop(Iterator first, Iterator last, Pred pred)
+    {
+        const auto size{std::distance(first, last)};
+        std::ptrdiff_t low{}, high{1};
+        while (high <= size && pred(first[high - 1])){
+            low = high;
+            high = 2 * high + 1;
+        }
+        return std::partition_point(first + low, first + std::min(high - 1, size), pred);
+    }
+
+    void merge(ValueType* first, ValueType* middle, ValueType* last)
+    {
+        first = gallop(first, middle, [this, middle](const ValueType& value){
+            ++m_comparison;
+            return !less(*middle, value);
+        });
+        if (first == middle){
+            return;
+        }
+        last = gallop(middle, last, [this, middle](const ValueType& value){
+            ++m_comparison;
+            return less(value, *(middle - 1));
+        });
+        if (middle - first <= last - middle){
+            merge_low(first, middle, last);
+        } else {
+            merge_high(first, middle, last);
+        }
+    }
+
+    /* the left run is not longer, it is moved to the buffer and the runs are merged from the front */
+    void merge_low(ValueType* first, ValueType* middle, ValueType* last)
+    {
+        m_buffer.assign(std::make_move_iterator(first), std::make_move_iterator(middle));
+        m_assignment += m_buffer.size();
+        auto left{m_buffer.data()};
+        auto left_last{left + m_buffer.size()};
+        auto right{middle};
+        auto out{first};
+        auto move_values = [&](ValueType*& from, std::ptrdiff_t count){
+            out = std::move(from, from + count, out);
+            from += count;
+            m_assignment += count;
+        };
+        while (left != left_last && right != last){
+            std::size_t left_wins{}, right_wins{};
+            while (left != left_last && right != last &&
+                   left_wins < m_min_gallop && right_wins < m_min_gallop){
+                ++m_comparison;
+                if (less(*right, *left)){
+                    move_values(right, 1);
+                    ++right_wins;
+                    left_wins = 0;
+                } else {
+                    move_values(left, 1);
+                    ++left_wins;
+                    right_wins = 0;
+                }
+            }
+            while (left != left_last && right != last){
+                auto left_count{gallop(left, left_last, [this, right](const ValueType& value){
+                    ++m_comparison;
+                    return !less(*right, value);
+                }) - left};
+                move_values(left, left_count);
+                if (left == left_last){
+                    break;
+                }
+                move_values(right, 1);
+                if (right == last){
+                    break;
+                }
+                auto right_count{gallop(right, last, [this, left](const ValueType& value){
+                    ++m_comparison;
+                    return less(value, *left);
+                }) - right};
+                move_values(right, right_count);
+                if (right == last){
+                    break;
+                }
+                move_values(left, 1);
+                if (std::cmp_less(left_count, initial_min_gallop) && std::cmp_less(right_count, initial_min_gallop)){
+                    ++m_min_gallop;
+                    break;
+                }
+                m_min_gallop -= m_min_gallop > 1;
+            }
+        }
+        move_values(left, left_last - left);
+    }
+
+    /* the right run is shorter, it is moved to the buffer and the runs are merged from the back */
+    void merge_high(ValueType* first, ValueType* middle, ValueType* last)
+    {
+        m_buffer.assign(std::make_move_iterator(middle), std::make_move_iterator(last));
+        m_assignment += m_buffer.size();
+        using reverse_t = std::reverse_iterator<ValueType*>;
+        reverse_t left{middle}, left_last{first};
+        reverse_t right{m_buffer.data() + m_buffer.size()}, right_last{m_buffer.data()};
+        reverse_t out{last};
+        auto move_values = [&](reverse_t& from, std::ptrdiff_t count){
+            out = std::move(from, from + count, out);
+            from += count;
+            m_assignment += count;
+        };
+        while (left != left_last && right != right_last){
+            std::size_t left_wins{}, right_wins{};
+            while (left != left_last && right != right_last &&
+                   left_wins < m_min_gallop && right_wins < m_min_gallop){
+                ++m_comparison;
+                if (less(*right, *left)){
+                    move_values(left, 1);
+                    ++left_wins;
+                    right_wins = 0;
+                } else {
+                    move_values(right, 1);
+                    ++right_wins;
+                    left_wins = 0;
+                }
+            }
+            while (left != left_last && right != right_last){
+                auto left_count{gallop(left, left_last, [this, right](const ValueType& value){
+                    ++m_comparison;
+                    return less(*right, value);
+                }) - left};
+                move_values(left, left_count);
+                if (left == left_last){
+                    break;
+                }
+                move_values(right, 1);
+                if (right == right_last){
+                    break;
+                }
+                auto right_count{gallop(right, right_last, [this, left](const ValueType& value){
+                    ++m_comparison;
+                    return !less(value, *left);
+                }) - right};
+                move_values(right, right_count);
+                if (right == right_last){
+                    break;
+                }
+                move_values(left, 1);
+                if (std::cmp_less(left_count, initial_min_gallop) && std::cmp_less(right_count, initial_min_gallop)){
+                    ++m_min_gallop;
+                    break;
+                }
+                m_min_gallop -= m_min_gallop > 1;
+            }
+        }
+        move_values(right, right_last - right);
+    }
+};
+
+} /* namespace algorithms */
+
+#endif /* TIM_SORT_HPP */
@@ -10,6 +10,9 @@ using T = int;
 using namespace algorithms;
 namespace po = boost::program_options;
 
+/* the exit status when an algorithm is significantly slower than its baseline */
+constexpr int regression_exit_code = 2;
+
 int main(int argc, char* argv[])
 {
     try {
@@ -30,7 +33,8 @@ int main(int argc, char* argv[])
         std::string_view author{"Written by Oğuz Toraman, oguz.toraman@tutanota.com"};
 
         sorting_algorithms<T> algorithms;
-        std::string input_size, test_count, input_file;
+        std::string input_size, test_count, input_file, thread_count, distribution, warmup_count;
+        std::string format, regression_threshold, algorithm_names, job_count;
         po::options_description command_line_options(usage);
         command_line_options.add_options()
             ("help,h", "display this help message")
@@ -38,9 +42,49 @@ int main(int argc, char* argv[])
             ("input-size", po::value<std::string>(&input_size)->default_value(
                  std::to_string(algorithms.default_input_size)), "the number of randomly generated inputs to be sorted")
             ("input-file", po::value<std::string>(&input_file), "read inputs from a file")
+            ("memory-limit", po::value<std::string>(),
+                 "sort the input file in about this much memory, e.g. 512M, by merging sorted runs "
+                 "spilled to temporary files, for files larger than the memory")
+            ("output-file", po::value<std::string>(),
+                 "where to write the inputs sorted with a memory limit, sorted.txt or sorted.bin by default")
+            ("temp-dir", po::value<std::string>(), "where to spill the sorted runs, the system temporary directory by default")
             ("test-count", po::value<std::string>(&test_count)->default_value(
                  std::to_string(algorithms.default_test_count)), "how many times to perform sorting per algorithm")
+            ("warmup", po::value<std::string>(&warmup_count)->default_value(
+                 std::to_string(algorithms.default_warmup_count)), "untimed sortings per algorithm before the timed ones")
+            ("target-error", po::value<std::string>(),
+                 "stop sorting once the 95% confidence interval of the median time is within this percent, "
+                 "test count is then the maximum")
+            ("no-verify", "skip checking that every algorithm sorted its inputs, and stably if it is stable, "
+                 "for runs that only measure time")
+            ("statistics", "show the minimum, p90 and p99 times, the deviation, the error of the median "
+                 "and the outliers left out of the mean")
+            ("sweep", po::value<std::string>(),
+                 "compare on a series of input sizes first:last:xfactor or first:last:+step, e.g. 1e3:1e6:x2, "
+                 "and fit the times to n, n log n and n^2")
+            ("records", po::value<std::string>(),
+                 "sort records of each input as the key and a payload of these sizes in bytes instead, "
+                 "a comma separated list of 8, 16, 32, 64, 128 and 256 or all, by argsort, pointers and structs")
+            ("algorithms", po::value<std::string>(&algorithm_names)->default_value("all"),
+                 "a comma separated list of the algorithms to compare, as named in the table")
             ("generate", po::value<std::string>(), "the number of files each containing randomly generated inputs")
+            ("binary", "write generated and sorted files in the binary input format")
+            ("distribution", po::value<std::string>(&distribution)->default_value("uniform"),
+                 "distribution of the generated inputs, a comma separated list or all:\n"
+                 "uniform, sorted, reverse, swapped, sawtooth, organ-pipe, few-unique, zipf")
+            ("seed", po::value<std::string>(), "seed of the random inputs, a fixed seed reproduces the same inputs")
+            ("threads", po::value<std::string>(&thread_count)->default_value(
+                 std::to_string(algorithms.get_thread_count())), "the number of threads used by parallel algorithms")
+            ("jobs", po::value<std::string>(&job_count)->default_value(
+                 std::to_string(algorithms.default_concurrent_jobs)),
+                 "the number of serial algorithms tested at the same time, each on its own pinned cpu")
+            ("perf", "count cycles, instructions, branch, cache and tlb misses of the timed runs")
+            ("format", po::value<std::string>(&format)->default_value("table"), "format of the results: table, json or csv")
+            ("baseline", po::value<std::string>(),
+                 "compare the results with the json results of an earlier run, "
+                 "exit with 2 if an algorithm is significantly slower")
+            ("regression-threshold", po::value<std::string>(&regression_threshold)->default_value("5"),
+                 "the percent an algorithm must be slower than its baseline to be reported")
         ;
         po::variables_map variables_map;
         po::store(po::parse_command_line(argc, argv, command_line_options), variables_map);
@@ -72,6 +116,55 @@ int main(int argc, char* argv[])
                 "test count cannot be grater than " + algorithm_comparison_table::readable(std_int64_t_max)
             };
         }
+        if (thread_count.length() > std_int64_t_max.length()){
+            throw std::runtime_error{
+                "thread count cannot be grater than " + algorithm_comparison_table::readable(std_int64_t_max)
+            };
+        }
+        algorithms.set_thread_count(std::stol(thread_count));
+        algorithms.set_warmup_count(std::stol(warmup_count));
+        algorithms.set_concurrent_jobs(std::stol(job_count));
+        if (variables_map.count("target-error")){
+            algorithms.set_target_error(std::stod(variables_map["target-error"].as<std::string>()) / 100.);
+        }
+        if (variables_map.count("no-verify")){
+            algorithms.set_verification(false);
+        }
+        if (variables_map.count("statistics")){
+            algorithms.set_statistics(true);
+        }
+        auto distributions{parse_input_distributions(distribution)};
+        auto algorithm_select{algorithms.parse_algorithms(algorithm_names)};
+        auto output_format{parse_result_format(format)};
+        /* only the results are written to the standard output when they are read by other programs */
+        std::ostream& progress{output_format == result_format::table ? std::cout : std::cerr};
+        auto print_results = [&](const std::string& table){
+            switch (output_format){
+            case result_format::table:
+                std::cout << table;
+                break;
+            case result_format::json:
+                std::cout << results_to_json(algorithms.get_results(), algorithms.get_seed());
+                break;
+            case result_format::csv:
+                std::cout << results_to_csv(algorithms.get_results());
+                break;
+            }
+        };
+        std::vector<baseline_result> baseline;
+        if (variables_map.count("baseline")){
+            baseline = read_baseline(variables_map["baseline"].as<std::string>());
+        }
+        if (variables_map.count("perf")){
+            if (!perf_counters{}.available()){
+                std::cerr << "hardware counters are not available, "
+                             "perf_event_paranoid may not permit counting\n";
+            }
+            algorithms.set_hardware_counters(true);
+        }
+        if (variables_map.count("seed")){
+            algorithms.set_seed(std::stoull(variables_map["seed"].as<std::string>()));
+        }
         if (variables_map.count("generate")){
             auto output_file_count{variables_map["generate"].as<std::string>()};
             if (output_file_count.length() > std_int64_t_max.length()){
@@ -79,13 +172,22 @@ int main(int argc, char* argv[])
                     "cannot be generate more than " + algorithm_comparison_table::readable(std_int64_t_max) + " files"
                 };
             }
+            if (distributions.size() > 1){
+                throw std::runtime_error{"files can be generated for only one distribution"};
+            }
             std::cout << "generating "
                       << algorithm_comparison_table::readable(output_file_count)
                       << " files, each containing "
                       << algorithm_comparison_table::readable(input_size)
-                      << " random inputs, please wait...\n"
+                      << " random inputs with seed "
+                      << algorithms.get_seed()
+                      << ", please wait...\n"
             ;
-            sorting_algorithms<T>::generate_input_files(std::stol(input_size), std::stol(output_file_count));
+            sorting_algorithms<T>::generate_input_files(
+                std::stol(input_size), std::stol(output_file_count),
+                variables_map.count("binary") ? input_file_format::binary : input_file_format::text,
+                distributions.front()
+            );
             std::cout << "generated "
                       << algorithm_comparison_table::readable(output_file_count)
                       << " files, each containing "
@@ -94,19 +196,97 @@ int main(int argc, char* argv[])
             ;
             return EXIT_SUCCESS;
         }
-        if (variables_map.count("input-file")){
-            algorithms.set(input_file, std::stol(test_count));
-            input_size = std::to_string(algorithms.get_input_size());
+        if (variables_map.count("memory-limit")){
+            if (!variables_map.count("input-file")){
+                throw std::runtime_error{"a memory limit needs an input file"};
+            }
+            auto sorted_format{variables_map.count("binary") ? input_file_format::binary : input_file_format::text};
+            auto output_file{variables_map.count("output-file") ?
+                             variables_map["output-file"].as<std::string>() :
+                             "sorted" + input_file_writer<T>::extension(sorted_format)};
+            auto memory_limit{parse_byte_size(variables_map["memory-limit"].as<std::string>())};
+            auto temp_directory{variables_map.count("temp-dir") ?
+                                std::filesystem::path{variables_map["temp-dir"].as<std::string>()} :
+                                std::filesystem::temp_directory_path()};
+            progress << "sorting " << input_file << " into " << output_file << " with a memory limit of "
+                     << algorithm_comparison_table::readable(memory_limit) << " bytes, please wait...\n";
+            print_results(algorithms.external_sort(
+                input_file, output_file, memory_limit, sorted_format, temp_directory
+            ));
+            return EXIT_SUCCESS;
+        }
+        if (variables_map.count("output-file") || variables_map.count("temp-dir")){
+            throw std::runtime_error{"an output file and a temporary directory need a memory limit"};
+        }
+        std::vector<std::size_t> payload_sizes;
+        if (variables_map.count("records")){
+            if (variables_map.count("sweep")){
+                throw std::runtime_error{"records cannot be sorted over a sweep of input sizes"};
+            }
+            payload_sizes = parse_record_payload_sizes(variables_map["records"].as<std::string>());
+        }
+        std::vector<std::int64_t> input_sizes;
+        if (variables_map.count("sweep")){
+            if (variables_map.count("input-file")){
+                throw std::runtime_error{"input sizes cannot be swept over an input file"};
+            }
+            input_sizes = parse_input_size_sweep(variables_map["sweep"].as<std::string>());
+            algorithms.set_test_count(std::stol(test_count));
+            progress << "sorting algorithms are comparing for "
+                     << algorithm_comparison_table::readable(input_sizes.front()) << " to "
+                     << algorithm_comparison_table::readable(input_sizes.back())
+                     << " inputs in " << input_sizes.size()
+                     << " steps, each sorting is performing "
+                     << algorithm_comparison_table::readable(test_count)
+                     << " times per algorithm, please wait...\n"
+            ;
         } else {
-            algorithms.set(std::stol(input_size), std::stol(test_count));
+            if (variables_map.count("input-file")){
+                algorithms.set(input_file, std::stol(test_count));
+                input_size = std::to_string(algorithms.get_input_size());
+                progress << "loaded "
+                         << algorithm_comparison_table::readable(input_size)
+                         << " inputs from " << input_file << " in "
+                         << algorithm_comparison_table::readable(algorithms.get_load_time())
+                         << '\n'
+                ;
+            } else {
+                algorithms.set(std::stol(input_size), std::stol(test_count), distributions.front());
+            }
+            progress << "sorting algorithms are comparing for "
+                     << algorithm_comparison_table::readable(input_size)
+                     << " inputs, each sorting is performing "
+                     << algorithm_comparison_table::readable(test_count)
+                     << " times per algorithm, please wait...\n"
+            ;
+        }
+        std::string table;
+        if (!payload_sizes.empty()){
+            table = variables_map.count("input-file") ? algorithms.compare_records(payload_sizes) :
+                                                        algorithms.compare_records(payload_sizes, distributions);
+        } else if (!input_sizes.empty()){
+            table = algorithms.sweep(algorithm_select, input_sizes, distributions);
+        } else if (variables_map.count("input-file")){
+            table = algorithms.compare(algorithm_select);
+        } else {
+            table = algorithms.compare(algorithm_select, distributions);
+        }
+        print_results(table);
+        if (variables_map.count("baseline")){
+            auto regressions{find_regressions(
+                algorithms.get_results(), baseline, std::stod(regression_threshold) / 100.
+            )};
+            for (const auto& [stored, median_time, slowdown] : regressions){
+                std::cerr << stored.algorithm << " is x" << std::format("{:.2f}", slowdown)
+                          << " slower than its baseline on "
+                          << algorithm_comparison_table::readable(stored.input_size) << ' '
+                          << stored.distribution << " inputs, median time "
+                          << algorithm_comparison_table::readable(median_time) << '\n';
+            }
+            if (!regressions.empty()){
+                return regression_exit_code;
+            }
         }
-        std::cout << "sorting algorithms are comparing for "
-                  << algorithm_comparison_table::readable(input_size)
-                  << " inputs, each sorting is performing "
-                  << algorithm_comparison_table::readable(test_count)
-                  << " times per algorithm, please wait...\n"
-        ;
-        std::cout << algorithms.compare(algorithms.all);
     } catch (const std::bad_alloc& e) {
         std::cerr << "there is not enough free memory to run sorting-algorithms\n";
         return EXIT_FAILURE;